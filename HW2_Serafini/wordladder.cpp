@@ -7,29 +7,30 @@
 #include <cmath>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
 #include "console.h"
+#include "../Shared/compactlexicon.h"
 #include "lexicon.h"
 #include "queue.h"
 #include <unordered_set>
 using namespace std;
 
 void printGreetings();
-void promptDictionary(fstream&, string&, Lexicon&);
+shared_ptr<const CompactLexicon> promptDictionary(fstream&, string&);
 bool promptWords(string&, string&);
-bool validFormat(const Lexicon&, const string&, const string&);
+bool validFormat(const CompactLexicon&, const string&, const string&);
 void printStack(Stack<string>);
-void findWordLadder(const string&, const string&, const Lexicon&);
+void findWordLadder(const string&, const string&, const CompactLexicon&);
 
 int main() {
     fstream inFile;
     string fileName, startWord, endWord;
-    Lexicon dictionary;
 
     printGreetings();
-    promptDictionary(inFile, fileName, dictionary);
+    shared_ptr<const CompactLexicon> dictionary = promptDictionary(inFile, fileName);
     while (promptWords(startWord, endWord)) {
-        findWordLadder(startWord, endWord, dictionary);
+        findWordLadder(startWord, endWord, *dictionary);
     }
 
     cout << "Have a nice day!" << endl;
@@ -45,7 +46,10 @@ void printGreetings() {
          << endl;
 }
 
-void promptDictionary(fstream& inFile, string& fileName, Lexicon& dictionary) {
+// The dictionary may be a word list or a file compiled by lexiconcompile, which is
+// mapped into memory instead of being read word by word. Unlike a Lexicon, it leaves
+// out words with characters outside A-Z, such as hyphens, apostrophes or digits.
+shared_ptr<const CompactLexicon> promptDictionary(fstream& inFile, string& fileName) {
     while (true) {
         cout << "Dictionary file name? ";
         getline(cin, fileName);
@@ -53,7 +57,8 @@ void promptDictionary(fstream& inFile, string& fileName, Lexicon& dictionary) {
         if (!inFile.fail()) break;
         cout << "Unable to open that file.  Try again." << endl;
     }
-    dictionary.addWordsFromFile(inFile);
+    inFile.close();
+    return CompactLexicon::open(fileName);
 }
 
 bool promptWords(string& startWord, string& endWord) {
@@ -73,7 +78,7 @@ bool promptWords(string& startWord, string& endWord) {
     return true;
 }
 
-bool validFormat(const Lexicon& dictionary, const string& startWord, const string&  endWord) {
+bool validFormat(const CompactLexicon& dictionary, const string& startWord, const string&  endWord) {
     if (!dictionary.contains(startWord) || !dictionary.contains(endWord)) {
         cout << "The two words must be found in the dictionary." << endl;
         return false;
@@ -101,27 +106,36 @@ void printResult(const string& startW, const string& endW, Stack<string>& ladder
     }
 }
 
-Lexicon neighborsOf(string currWord, const Lexicon& dictionary, Lexicon& usedWords) {
+Lexicon neighborsOf(string currWord, const CompactLexicon& dictionary, Lexicon& usedWords) {
     // Find all neighbors of current word and store them into "neighbors":
     Lexicon neighbors;          // all neighbors of current word
     int size = currWord.size(); // word length
+    int prefix = CompactLexicon::ROOT; // dictionary node of the letters before i
 
-    // loop through the first letter to last letter of current word.
-    for (int i = 0; i < size; i++) {
+    // loop through the first letter to last letter of current word, as long as the letters before it start a word.
+    for (int i = 0; i < size && prefix >= 0; i++) {
         for(char letter = 'a'; letter <= 'z'; letter++) {
+            // walk on from the shared prefix: the new letter, then the rest of current word
+            int node = dictionary.child(prefix, letter);
+            for (int j = i + 1; j < size && node >= 0; j++) {
+                node = dictionary.child(node, currWord[j]);
+            }
+            if (node < 0 || !dictionary.isWord(node)) continue;
+
             string temp = currWord;
             temp[i] = letter;
-            if (dictionary.contains(temp) && !usedWords.contains(temp)) { // if is legal word and not been used yet.
+            if (!usedWords.contains(temp)) { // if is legal word and not been used yet.
                 neighbors.add(temp);    // add it into neighbors collection
                 usedWords.add(temp);    // also add it into used collection
             }
         }
+        prefix = dictionary.child(prefix, currWord[i]);
     }
     return neighbors;
 }
 
 // findWordLadder(), this BFS algorithm check solution only when dequeueing a node from queue => slightly slower!
-void findWordLadder(const string& startWord, const string& endWord, const Lexicon& dictionary) {
+void findWordLadder(const string& startWord, const string& endWord, const CompactLexicon& dictionary) {
     // If invalid format, terminate this function:
     if (!validFormat(dictionary, startWord, endWord)) return;
 
@@ -0,0 +1,178 @@
+//
+//  bigfixed.cpp
+//
+//  Created by Jian Zhong on 9/2/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#include "bigfixed.h"
+#include <cctype>
+#include <cmath>
+#include "error.h"
+
+BigFixed::BigFixed() {
+    negative = false;
+    for (int i = 0; i < LIMBS; i++) limbs[i] = 0;
+}
+
+BigFixed::BigFixed(double value) : BigFixed() {
+    negative = value < 0;
+    value = fabs(value);
+    if (value >= 4294967296.0) error("BigFixed: value out of range.");
+
+    // integer part, then peel off the fraction 32 bits at a time (exact for a double)
+    double whole = floor(value);
+    limbs[LIMBS - 1] = (uint32_t) whole;
+    double fraction = value - whole;
+    for (int i = LIMBS - 2; i >= 0 && fraction != 0; i--) {
+        fraction *= 4294967296.0;
+        double limb = floor(fraction);
+        limbs[i] = (uint32_t) limb;
+        fraction -= limb;
+    }
+}
+
+BigFixed::BigFixed(const string& decimal) : BigFixed() {
+    unsigned pos = 0;
+    bool isNegative = false;
+    if (pos < decimal.length() && (decimal[pos] == '-' || decimal[pos] == '+')) {
+        isNegative = decimal[pos] == '-';
+        pos++;
+    }
+
+    // integer part
+    uint64_t whole = 0;
+    for (; pos < decimal.length() && isdigit(decimal[pos]); pos++) {
+        whole = whole * 10 + (decimal[pos] - '0');
+        if (whole > 0xffffffffULL) error("BigFixed: value out of range.");
+    }
+
+    // fraction part: from the last digit back, fraction = (digit + fraction) / 10
+    if (pos < decimal.length() && decimal[pos] == '.') {
+        unsigned first = ++pos;
+        while (pos < decimal.length() && isdigit(decimal[pos])) pos++;
+        for (unsigned i = pos; i > first; i--) {
+            limbs[LIMBS - 1] = decimal[i - 1] - '0';
+            *this = divide(10);
+        }
+    }
+
+    if (pos != decimal.length()) error("BigFixed: \"" + decimal + "\" is not a decimal number.");
+    limbs[LIMBS - 1] = (uint32_t) whole;
+    negative = isNegative && !isZero();
+}
+
+BigFixed BigFixed::operator+(const BigFixed& other) const {
+    if (negative == other.negative) {
+        BigFixed sum = addMagnitude(other);
+        sum.negative = negative;
+        return sum;
+    }
+
+    // opposite signs: subtract the smaller magnitude from the larger one
+    if (compareMagnitude(other) >= 0) {
+        BigFixed diff = subtractMagnitude(other);
+        diff.negative = negative && !diff.isZero();
+        return diff;
+    } else {
+        BigFixed diff = other.subtractMagnitude(*this);
+        diff.negative = other.negative;
+        return diff;
+    }
+}
+
+BigFixed BigFixed::operator-(const BigFixed& other) const {
+    BigFixed negated = other;
+    negated.negative = !other.negative && !other.isZero();
+    return *this + negated;
+}
+
+BigFixed BigFixed::operator*(const BigFixed& other) const {
+    // schoolbook product; the product has 2 * fraction limbs below the point, so
+    // the result is limbs [FRACTION, FRACTION + LIMBS) of the full product.
+    const int F = BIGFIXED_FRACTION_LIMBS;
+    uint64_t product[2 * LIMBS] = {0};
+
+    for (int i = 0; i < LIMBS; i++) {
+        if (limbs[i] == 0) continue;
+        uint64_t carry = 0;
+        for (int j = 0; j < LIMBS; j++) {
+            uint64_t t = (uint64_t) limbs[i] * other.limbs[j] + product[i + j] + carry;
+            product[i + j] = (uint32_t) t;
+            carry = t >> 32;
+        }
+        product[i + LIMBS] += carry;
+    }
+
+    for (int k = F + LIMBS; k < 2 * LIMBS; k++) {
+        if (product[k] != 0) error("BigFixed: multiplication overflow.");
+    }
+
+    BigFixed result;
+    for (int i = 0; i < LIMBS; i++) {
+        result.limbs[i] = (uint32_t) product[i + F];
+    }
+    result.negative = (negative != other.negative) && !result.isZero();
+    return result;
+}
+
+BigFixed BigFixed::divide(uint32_t divisor) const {
+    BigFixed result;
+    uint64_t remainder = 0;
+    for (int i = LIMBS - 1; i >= 0; i--) {  // long division from the most significant limb
+        uint64_t current = (remainder << 32) | limbs[i];
+        result.limbs[i] = (uint32_t) (current / divisor);
+        remainder = current % divisor;
+    }
+    result.negative = negative && !result.isZero();
+    return result;
+}
+
+double BigFixed::toDouble() const {
+    // start at the most significant non-zero limb; three limbs cover a double's 53 bits
+    int top = LIMBS - 1;
+    while (top > 0 && limbs[top] == 0) top--;
+
+    double value = 0;
+    for (int i = top; i >= 0 && i > top - 3; i--) {
+        value += ldexp((double) limbs[i], 32 * (i - BIGFIXED_FRACTION_LIMBS));
+    }
+    return negative ? -value : value;
+}
+
+int BigFixed::compareMagnitude(const BigFixed& other) const {
+    for (int i = LIMBS - 1; i >= 0; i--) {
+        if (limbs[i] != other.limbs[i]) return limbs[i] < other.limbs[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+BigFixed BigFixed::addMagnitude(const BigFixed& other) const {
+    BigFixed sum;
+    uint64_t carry = 0;
+    for (int i = 0; i < LIMBS; i++) {
+        uint64_t t = (uint64_t) limbs[i] + other.limbs[i] + carry;
+        sum.limbs[i] = (uint32_t) t;
+        carry = t >> 32;
+    }
+    if (carry != 0) error("BigFixed: addition overflow.");
+    return sum;
+}
+
+BigFixed BigFixed::subtractMagnitude(const BigFixed& other) const {
+    BigFixed diff;
+    int64_t borrow = 0;
+    for (int i = 0; i < LIMBS; i++) {
+        int64_t t = (int64_t) limbs[i] - other.limbs[i] - borrow;
+        borrow = t < 0 ? 1 : 0;
+        diff.limbs[i] = (uint32_t) (t + (borrow << 32));
+    }
+    return diff;
+}
+
+bool BigFixed::isZero() const {
+    for (int i = 0; i < LIMBS; i++) {
+        if (limbs[i] != 0) return false;
+    }
+    return true;
+}
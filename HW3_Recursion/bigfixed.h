@@ -0,0 +1,80 @@
+//
+//  bigfixed.h
+//
+//  A signed fixed-point number with a 32-bit integer part and a long binary
+//  fraction, used for the high-precision reference orbit of deep Mandelbrot zooms.
+//
+//  Created by Jian Zhong on 9/2/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#ifndef _bigfixed_h
+#define _bigfixed_h
+
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+// 32-bit limbs after the binary point: 14 limbs = 448 bits, about 1e-134.
+const int BIGFIXED_FRACTION_LIMBS = 14;
+
+class BigFixed {
+public:
+    /*
+     * Construct a zero.
+     */
+    BigFixed();
+
+    /*
+     * Construct the exact value of a double (its integer part must fit in 32 bits).
+     */
+    BigFixed(double value);
+
+    /*
+     * Construct from a decimal string such as "-0.7436438870371587047522".
+     */
+    BigFixed(const string& decimal);
+
+    /*
+     * Arithmetic; results are truncated to the fraction precision.
+     */
+    BigFixed operator+(const BigFixed& other) const;
+    BigFixed operator-(const BigFixed& other) const;
+    BigFixed operator*(const BigFixed& other) const;
+
+    /*
+     * Divide by a small positive integer, used when parsing decimals.
+     */
+    BigFixed divide(uint32_t divisor) const;
+
+    /*
+     * Get a double within about an ulp of the value. The top three limbs are converted
+     * and summed one at a time, so the result is not always the nearest double.
+     */
+    double toDouble() const;
+
+private:
+    static const int LIMBS = BIGFIXED_FRACTION_LIMBS + 1;
+
+    /*
+     * Compare magnitudes, ignoring signs: negative, zero or positive like strcmp.
+     */
+    int compareMagnitude(const BigFixed& other) const;
+
+    /*
+     * Add or subtract magnitudes, ignoring signs (subtract requires |this| >= |other|).
+     */
+    BigFixed addMagnitude(const BigFixed& other) const;
+    BigFixed subtractMagnitude(const BigFixed& other) const;
+
+    /*
+     * Return true if every limb is zero.
+     */
+    bool isZero() const;
+
+    bool negative;          // sign of the number
+    uint32_t limbs[LIMBS];  // magnitude, least significant first; limbs[LIMBS-1] is the integer part
+};
+
+#endif // _bigfixed_h
@@ -0,0 +1,131 @@
+//
+//  compiledgrammar.h
+//
+//  A BNF grammar compiled once into integer symbol ids and flat, pre-tokenized
+//  production arrays, so that expanding it needs no string parsing or hashing.
+//
+//  Created by Jian Zhong on 9/10/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#ifndef _compiledgrammar_h
+#define _compiledgrammar_h
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "hashmap.h"
+#include "vector.h"
+
+using namespace std;
+
+/*
+ * Symbols are numbered non-terminals first (0 .. numNonTerminals - 1), then terminals.
+ * The productions of non-terminal A are [firstProduction[A], firstProduction[A + 1]),
+ * and the symbols of production p are tokens[firstToken[p] .. firstToken[p + 1]).
+ */
+struct CompiledGrammar {
+    int numNonTerminals = 0;
+    Vector<string> symbolText;      // id -> symbol as written in the BNF file
+    HashMap<string, int> symbolIds; // symbol -> id, for looking up start symbols
+    Vector<int> firstProduction;    // size numNonTerminals + 1
+    Vector<int> firstToken;         // size (number of productions) + 1
+    Vector<int> tokens;             // symbol ids of all productions, back to back
+
+    /*
+     * Return true if the symbol id is a non-terminal.
+     */
+    bool isNonTerminal(int symbol) const {
+        return symbol < numNonTerminals;
+    }
+
+    /*
+     * Get the id of a symbol, or -1 if it does not appear in the grammar.
+     */
+    int idOf(const string& symbol) const {
+        return symbolIds.containsKey(symbol) ? symbolIds.get(symbol) : -1;
+    }
+};
+
+/*
+ * A small random stream (splitmix64) owned by one expander, so expansions on
+ * different threads neither share nor lock the global random.h generator.
+ */
+struct GrammarRng {
+    uint64_t state;
+
+    explicit GrammarRng(uint64_t seed) : state(seed) {
+    }
+
+    /*
+     * Return the next 64 random bits.
+     */
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    /*
+     * Return a random integer in [0, bound).
+     */
+    int nextInt(int bound) {
+        return (int) (((next() >> 32) * (uint64_t) bound) >> 32);
+    }
+};
+
+/* Limits for grammars that could expand forever; exceeding one is an error */
+struct ExpansionLimits {
+    int maxDepth = 10000;     // deepest nesting of non-terminals in one expansion
+    int maxLength = 1000000;  // most characters in one result
+};
+
+/*
+ * Expands symbols of a compiled grammar at random without recursion: pending symbols
+ * sit on an explicit stack, and results are appended into one output buffer that is
+ * reused from call to call.
+ */
+class GrammarExpander {
+public:
+    /*
+     * Construct an expander for a grammar, which must outlive it.
+     */
+    GrammarExpander(const CompiledGrammar& grammar, const ExpansionLimits& limits = ExpansionLimits());
+
+    /*
+     * Expand a symbol id: terminals are written out followed by a space, and an empty
+     * rule is written as a single space. Rules are chosen with rng, or with random.h
+     * when it is null. The result is only valid until the next call.
+     */
+    const string& expand(int symbol, GrammarRng* rng = nullptr);
+
+private:
+    struct PendingSymbol {
+        int symbol;
+        int depth;
+    };
+
+    const CompiledGrammar& grammar;
+    ExpansionLimits limits;
+    std::vector<PendingSymbol> stack; // symbols still to expand, leftmost on top
+    string output;                    // the reused output buffer
+};
+
+/*
+ * Read a BNF file ("symbol::=rule|rule|...", symbols in a rule separated by spaces)
+ * and compile it. When a symbol is defined twice, the last definition wins. An empty
+ * rule, as in "A::=x||y", compiles to a production with no symbols.
+ */
+CompiledGrammar scanFileIntoMap(istream& input);
+
+/*
+ * Like grammarGenerate, but spreads the expansions over numThreads threads (0 means
+ * one per core). Result i is expanded with its own stream seeded from seed and i,
+ * so the results depend only on seed, never on the thread count.
+ */
+Vector<string> grammarGenerateParallel(istream& input, const string& symbol, int times,
+                                       uint64_t seed, int numThreads = 0);
+
+#endif // _compiledgrammar_h
@@ -0,0 +1,433 @@
+//
+//  earleyparser.cpp
+//
+//  Created by Jian Zhong on 9/14/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#include "earleyparser.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <climits>
+#include <thread>
+#include "error.h"
+
+// Markers in leoTop besides an index into leoItems.
+const int LEO_NONE = -1;     // no deterministic reduction
+const int LEO_UNKNOWN = -2;  // not computed yet
+const int LEO_ACTIVE = -3;   // being computed (a unit-rule cycle)
+
+// Number of sentences a findRejectedSentences worker claims at a time.
+const int RECOGNIZE_CHUNK = 64;
+
+EarleyParser::EarleyParser(const CompiledGrammar& grammar) : grammar(grammar) {
+    numProductions = grammar.firstToken.size() - 1;
+    for (int symbol = 0; symbol < grammar.numNonTerminals; symbol++) {
+        for (int p = grammar.firstProduction[symbol]; p < grammar.firstProduction[symbol + 1]; p++) {
+            productionSymbol.push_back(symbol);
+            productionFirst.push_back(grammar.firstToken[p]);
+            productionLength.push_back(grammar.firstToken[p + 1] - grammar.firstToken[p]);
+        }
+    }
+    for (int token : grammar.tokens) {
+        rhs.push_back(token);
+    }
+
+    // start rule numProductions + S is "S' ::= S"; its completion accepts a sentence
+    for (int symbol = 0; symbol < grammar.numNonTerminals; symbol++) {
+        productionSymbol.push_back(-1);
+        productionFirst.push_back(rhs.size());
+        productionLength.push_back(1);
+        rhs.push_back(symbol);
+    }
+
+    // a non-terminal is nullable if one of its rules has only nullable symbols
+    nullable.assign(grammar.numNonTerminals, false);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int p = 0; p < numProductions; p++) {
+            if (nullable[productionSymbol[p]]) continue;
+            bool empty = true;
+            for (int i = 0; i < productionLength[p] && empty; i++) {
+                int symbol = rhs[productionFirst[p] + i];
+                empty = grammar.isNonTerminal(symbol) && nullable[symbol];
+            }
+            if (empty) {
+                nullable[productionSymbol[p]] = true;
+                changed = true;
+            }
+        }
+    }
+
+    stamp = 0;
+    predictedStamp.assign(grammar.numNonTerminals, -1);
+    slots.assign(64, 0);
+    slotStamp.assign(64, -1);
+}
+
+bool EarleyParser::recognize(const string& sentence, int start) {
+    if (!grammar.isNonTerminal(start)) error("EarleyParser: the start symbol must be a non-terminal.");
+    return tokenize(sentence) && runChart(start, true);
+}
+
+bool EarleyParser::parse(const string& sentence, int start, ParseNode& tree) {
+    if (!grammar.isNonTerminal(start)) error("EarleyParser: the start symbol must be a non-terminal.");
+
+    // Leo's optimization leaves out completed items that a tree needs, so build the full chart
+    if (!tokenize(sentence) || !runChart(start, false)) return false;
+
+    vector<pair<int, pair<int, int> > > active;
+    return buildSymbol(start, 0, words.size(), tree, active);
+}
+
+/// Function to split a sentence at whitespace into terminal ids.
+/// @return false if a word is not a terminal of the grammar
+bool EarleyParser::tokenize(const string& sentence) {
+    words.clear();
+    int length = sentence.length();
+    for (int i = 0; i < length; ) {
+        if (isspace((unsigned char) sentence[i])) {
+            i++;
+            continue;
+        }
+        int end = i;
+        while (end < length && !isspace((unsigned char) sentence[end])) end++;
+        int id = grammar.idOf(sentence.substr(i, end - i));
+        if (id < 0 || grammar.isNonTerminal(id)) return false;
+        words.push_back(id);
+        i = end;
+    }
+    return true;
+}
+
+/// Function to fill the chart for the current words. Set k holds the items whose
+/// symbols before the dot derive words [origin, k). Rules that can derive nothing are
+/// skipped over when predicted (Aycock and Horspool), so an empty completion never has
+/// to revisit its own set; with useLeo, a chain of right-recursive completions is
+/// replaced by its topmost item (Leo).
+/// @param start - Non-terminal the sentence must derive
+/// @return true if the sentence is derived from start
+bool EarleyParser::runChart(int start, bool useLeo) {
+    int n = words.size();
+    int startRule = numProductions + start;
+
+    items.clear();
+    setStart.clear();
+    scanned.clear();
+    waiting.clear();
+    waitingStart.assign(1, 0);
+    leoTop.clear();
+    leoItems.clear();
+
+    for (int k = 0; ; k++) {
+        // begin set k with the items scanned from set k - 1
+        if (stamp == INT_MAX) {
+            stamp = 0;
+            predictedStamp.assign(predictedStamp.size(), -1);
+            slotStamp.assign(slotStamp.size(), -1);
+        }
+        stamp++;
+        setStart.push_back(items.size());
+        if (k == 0) {
+            addItem({startRule, 0, 0});
+        }
+        for (const Item& item : scanned) {
+            addItem(item);
+        }
+        scanned.clear();
+
+        for (int i = setStart[k]; i < (int) items.size(); i++) {
+            Item item = items[i]; // a copy: adding items may move the arena
+
+            if (item.dot == productionLength[item.production]) {
+                // completion: advance the items of the origin set waiting on this symbol
+                int symbol = productionSymbol[item.production];
+                if (item.origin == k || symbol < 0) continue;
+
+                int top = useLeo ? leoItem(item.origin, symbol) : LEO_NONE;
+                if (top >= 0) {
+                    addItem(leoItems[top]);
+                    continue;
+                }
+                pair<int, int> range = waitingRange(item.origin, symbol);
+                for (int w = range.first; w < range.second; w++) {
+                    Item parent = items[waiting[w].second];
+                    parent.dot++;
+                    addItem(parent);
+                }
+
+            } else {
+                int next = rhs[productionFirst[item.production] + item.dot];
+                if (!grammar.isNonTerminal(next)) {
+                    // scan: the next set starts with the items matching the next word
+                    if (k < n && words[k] == next) {
+                        scanned.push_back({item.production, item.dot + 1, item.origin});
+                    }
+                } else {
+                    // prediction: each non-terminal's rules once per set
+                    if (predictedStamp[next] != stamp) {
+                        predictedStamp[next] = stamp;
+                        for (int p = grammar.firstProduction[next]; p < grammar.firstProduction[next + 1]; p++) {
+                            addItem({p, 0, k});
+                        }
+                    }
+                    if (nullable[next]) {
+                        addItem({item.production, item.dot + 1, item.origin});
+                    }
+                }
+            }
+        }
+
+        finishSet(k);
+        if (k == n) return containsItem({startRule, 1, 0});
+        if (scanned.empty()) return false;
+    }
+}
+
+/// Function to add an item to the current set unless it is already there.
+void EarleyParser::addItem(const Item& item) {
+    if ((items.size() - setStart.back() + 1) * 2 > slots.size()) growSlots();
+
+    unsigned mask = slots.size() - 1;
+    for (unsigned s = slotOf(item) & mask; ; s = (s + 1) & mask) {
+        if (slotStamp[s] != stamp) {
+            slotStamp[s] = stamp;
+            slots[s] = items.size();
+            items.push_back(item);
+            return;
+        }
+        const Item& other = items[slots[s]];
+        if (other.production == item.production && other.dot == item.dot && other.origin == item.origin) {
+            return;
+        }
+    }
+}
+
+/// Function to check whether the current set holds an item.
+bool EarleyParser::containsItem(const Item& item) const {
+    unsigned mask = slots.size() - 1;
+    for (unsigned s = slotOf(item) & mask; slotStamp[s] == stamp; s = (s + 1) & mask) {
+        const Item& other = items[slots[s]];
+        if (other.production == item.production && other.dot == item.dot && other.origin == item.origin) {
+            return true;
+        }
+    }
+    return false;
+}
+
+unsigned EarleyParser::slotOf(const Item& item) const {
+    unsigned h = item.production * 0x9e3779b1u;
+    h ^= (item.dot + 0x7f4a7c15u + (h << 6) + (h >> 2));
+    h ^= (item.origin * 0x85ebca6bu + (h << 6) + (h >> 2));
+    return h ^ (h >> 16);
+}
+
+/// Function to double the hash table and re-insert the items of the current set.
+void EarleyParser::growSlots() {
+    int size = slots.size() * 2;
+    slots.assign(size, 0);
+    slotStamp.assign(size, -1);
+
+    unsigned mask = size - 1;
+    for (int i = setStart.back(); i < (int) items.size(); i++) {
+        unsigned s = slotOf(items[i]) & mask;
+        while (slotStamp[s] == stamp) s = (s + 1) & mask;
+        slotStamp[s] = stamp;
+        slots[s] = i;
+    }
+}
+
+/// Function to index the items of a finished set by the non-terminal after their dot,
+/// so completions find the items waiting on a symbol with a binary search.
+void EarleyParser::finishSet(int k) {
+    int begin = waiting.size();
+    for (int i = setStart[k]; i < (int) items.size(); i++) {
+        const Item& item = items[i];
+        if (item.dot < productionLength[item.production]) {
+            int next = rhs[productionFirst[item.production] + item.dot];
+            if (grammar.isNonTerminal(next)) waiting.push_back(make_pair(next, i));
+        }
+    }
+    sort(waiting.begin() + begin, waiting.end());
+    waitingStart.push_back(waiting.size());
+    leoTop.resize(waiting.size(), LEO_UNKNOWN);
+}
+
+/// Function to find the items of a finished set waiting on a non-terminal.
+/// @return their range [first, second) in waiting
+pair<int, int> EarleyParser::waitingRange(int set, int symbol) const {
+    auto begin = waiting.begin() + waitingStart[set];
+    auto end = waiting.begin() + waitingStart[set + 1];
+    auto first = lower_bound(begin, end, make_pair(symbol, -1));
+    auto last = lower_bound(first, end, make_pair(symbol + 1, -1));
+    return make_pair(first - waiting.begin(), last - waiting.begin());
+}
+
+/// Function to find Leo's topmost item for completing symbol from a set: when the only
+/// item of the set waiting on symbol has it as its last symbol, completing symbol
+/// completes that item too, and so on up the chain. The result is memoized per set.
+/// @return index into leoItems of the completed item at the top of the chain, or LEO_NONE
+int EarleyParser::leoItem(int set, int symbol) {
+    pair<int, int> range = waitingRange(set, symbol);
+    if (range.second - range.first != 1) return LEO_NONE;
+
+    int w = range.first;
+    if (leoTop[w] == LEO_ACTIVE) return LEO_NONE;
+    if (leoTop[w] != LEO_UNKNOWN) return leoTop[w];
+
+    Item parent = items[waiting[w].second];
+    if (parent.dot + 1 != productionLength[parent.production]) {
+        leoTop[w] = LEO_NONE;
+        return LEO_NONE;
+    }
+
+    leoTop[w] = LEO_ACTIVE;
+    int parentSymbol = productionSymbol[parent.production];
+    int top = parentSymbol >= 0 ? leoItem(parent.origin, parentSymbol) : LEO_NONE;
+    if (top < 0) {
+        parent.dot++;
+        top = leoItems.size();
+        leoItems.push_back(parent);
+    }
+    leoTop[w] = top;
+    return top;
+}
+
+/// Function to build the parse tree of symbol over words [from, to) from a full chart.
+/// active holds the (symbol, span) pairs being built, so unit-rule cycles are skipped.
+/// @return false if no derivation was found
+bool EarleyParser::buildSymbol(int symbol, int from, int to, ParseNode& node,
+                               vector<pair<int, pair<int, int> > >& active) {
+    node.symbol = grammar.symbolText[symbol];
+    node.children.clear();
+    if (!grammar.isNonTerminal(symbol)) {
+        return to == from + 1 && words[from] == symbol;
+    }
+
+    pair<int, pair<int, int> > span = make_pair(symbol, make_pair(from, to));
+    if (find(active.begin(), active.end(), span) != active.end()) return false;
+    active.push_back(span);
+
+    int end = to + 1 < (int) setStart.size() ? setStart[to + 1] : items.size();
+    for (int i = setStart[to]; i < end; i++) {
+        Item item = items[i];
+        if (productionSymbol[item.production] == symbol && item.origin == from
+                && item.dot == productionLength[item.production]) {
+            if (buildRule(item.production, item.dot, from, to, node, active)) {
+                active.pop_back();
+                return true;
+            }
+            node.children.clear();
+        }
+    }
+    active.pop_back();
+    return false;
+}
+
+/// Function to append to node the subtrees of the first dot symbols of a production
+/// over words [from, to), given that item (production, dot, from) is in set to. The
+/// last symbol is matched first, trying each set where it could have started.
+/// @return false if no derivation was found
+bool EarleyParser::buildRule(int production, int dot, int from, int to, ParseNode& node,
+                             vector<pair<int, pair<int, int> > >& active) {
+    if (dot == 0) return from == to;
+
+    int symbol = rhs[productionFirst[production] + dot - 1];
+    if (!grammar.isNonTerminal(symbol)) {
+        // only a scan makes this item, so the shorter item is in set to - 1
+        if (!buildRule(production, dot - 1, from, to - 1, node, active)) return false;
+        ParseNode leaf;
+        leaf.symbol = grammar.symbolText[symbol];
+        node.children.add(leaf);
+        return true;
+    }
+
+    int mark = node.children.size();
+    int end = to + 1 < (int) setStart.size() ? setStart[to + 1] : items.size();
+    for (int i = setStart[to]; i < end; i++) {
+        // a completed symbol ending here, whose origin set holds the shorter item
+        const Item& done = items[i];
+        if (productionSymbol[done.production] != symbol || done.dot != productionLength[done.production]) continue;
+        int middle = done.origin;
+        if (middle < from) continue;
+
+        bool found = false;
+        pair<int, int> range = waitingRange(middle, symbol);
+        for (int w = range.first; w < range.second && !found; w++) {
+            const Item& parent = items[waiting[w].second];
+            found = parent.production == production && parent.dot == dot - 1 && parent.origin == from;
+        }
+        if (!found) continue;
+
+        ParseNode child;
+        if (buildRule(production, dot - 1, from, middle, node, active)
+                && buildSymbol(symbol, middle, to, child, active)) {
+            node.children.add(child);
+            return true;
+        }
+        while (node.children.size() > mark) {
+            node.children.remove(node.children.size() - 1);
+        }
+    }
+    return false;
+}
+
+/// Function to recognize many sentences on several threads, each with its own parser.
+/// Workers claim chunks of sentence indices from a shared counter.
+/// @param grammar - Compiled grammar
+/// @param sentences - Sentences to check
+/// @param symbol - Non-terminal the sentences must derive
+/// @param numThreads - Number of worker threads, 0 for one per core
+/// @return Vector of the indices of the sentences that are not derived
+Vector<int> findRejectedSentences(const CompiledGrammar& grammar, const Vector<string>& sentences,
+                                  const string& symbol, int numThreads) {
+    int start = grammar.idOf(symbol);
+    if (start < 0 || !grammar.isNonTerminal(start)) {
+        error("findRejectedSentences: " + symbol + " is not a non-terminal of the grammar.");
+    }
+
+    int count = sentences.size();
+    if (numThreads <= 0) numThreads = max(1, (int) thread::hardware_concurrency());
+    numThreads = max(1, min(numThreads, (count + RECOGNIZE_CHUNK - 1) / RECOGNIZE_CHUNK));
+
+    // char rather than vector<bool>, so concurrent writes to different entries do not race
+    std::vector<char> accepted(count);
+    atomic<int> nextChunk(0);
+    auto worker = [&]() {
+        EarleyParser parser(grammar);
+        for (;;) {
+            int first = nextChunk.fetch_add(RECOGNIZE_CHUNK);
+            if (first >= count) break;
+            for (int i = first; i < min(first + RECOGNIZE_CHUNK, count); i++) {
+                accepted[i] = parser.recognize(sentences[i], start);
+            }
+        }
+    };
+
+    std::vector<thread> workers;
+    for (int t = 1; t < numThreads; t++) {
+        workers.emplace_back(worker);
+    }
+    worker(); // the calling thread takes a share too
+    for (thread& t : workers) {
+        t.join();
+    }
+
+    Vector<int> rejected;
+    for (int i = 0; i < count; i++) {
+        if (!accepted[i]) rejected.add(i);
+    }
+    return rejected;
+}
+
+string parseTreeToString(const ParseNode& tree) {
+    if (tree.children.isEmpty()) return tree.symbol;
+
+    string result = "(" + tree.symbol;
+    for (const ParseNode& child : tree.children) {
+        result += " " + parseTreeToString(child);
+    }
+    return result + ")";
+}
@@ -0,0 +1,111 @@
+//
+//  earleyparser.h
+//
+//  Checks whether sentences belong to a compiled grammar (the same BNF files that
+//  grammarGenerate reads) with an Earley parser, and builds parse trees on request.
+//  Every parser keeps its chart in arenas that are reused from sentence to sentence.
+//
+//  Created by Jian Zhong on 9/14/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#ifndef _earleyparser_h
+#define _earleyparser_h
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "compiledgrammar.h"
+#include "vector.h"
+
+using namespace std;
+
+/* A node of a parse tree; terminals are the leaves */
+struct ParseNode {
+    string symbol;
+    Vector<ParseNode> children;
+};
+
+/*
+ * An Earley parser for one grammar. Sentences are words separated by whitespace,
+ * each of which must be a terminal of the grammar. Recognition uses Leo's
+ * optimization, so right recursion is linear like left recursion, and runs in
+ * linear time on the LR-regular grammars (which include the LR(k) ones). A parser
+ * may only be used by one thread at a time; give each thread its own.
+ */
+class EarleyParser {
+public:
+    /*
+     * Construct a parser for a grammar, which must outlive it.
+     */
+    EarleyParser(const CompiledGrammar& grammar);
+
+    /*
+     * Return true if sentence is derived from the non-terminal start.
+     */
+    bool recognize(const string& sentence, int start);
+
+    /*
+     * Return true if sentence is derived from the non-terminal start, and store one
+     * of its parse trees in tree. Trees need the full chart, so long right-recursive
+     * sentences take quadratic time here; use recognize when no tree is needed.
+     */
+    bool parse(const string& sentence, int start, ParseNode& tree);
+
+private:
+    /* An Earley item: rule production with dot symbols matched, started at origin */
+    struct Item {
+        int production;
+        int dot;
+        int origin;
+    };
+
+    const CompiledGrammar& grammar;
+    int numProductions;
+    vector<int> productionSymbol;   // production -> its non-terminal (-1 for a start rule)
+    vector<int> productionFirst;    // production -> index of its first symbol in rhs
+    vector<int> productionLength;
+    vector<int> rhs;                // the grammar's rules, then one start rule "S' ::= S" per non-terminal
+    vector<bool> nullable;          // non-terminal -> derives the empty sentence
+
+    // the chart, reused between sentences
+    vector<int> words;                  // the sentence as terminal ids
+    vector<Item> items;                 // all sets back to back
+    vector<int> setStart;               // set k is items [setStart[k], setStart[k + 1])
+    vector<Item> scanned;               // items for the next set
+    vector<pair<int, int> > waiting;    // per set, (next symbol, item) sorted by next symbol
+    vector<int> waitingStart;
+    vector<int> leoTop;                 // per waiting entry, memoized Leo item (see leoItem)
+    vector<Item> leoItems;
+    vector<int> slots;                  // hash table of the items in the current set
+    vector<int> slotStamp;
+    int stamp;
+    vector<int> predictedStamp;         // non-terminal -> stamp of the last set it was predicted in
+
+    bool tokenize(const string& sentence);
+    bool runChart(int start, bool useLeo);
+    void addItem(const Item& item);
+    bool containsItem(const Item& item) const;
+    unsigned slotOf(const Item& item) const;
+    void growSlots();
+    void finishSet(int k);
+    pair<int, int> waitingRange(int set, int symbol) const;
+    int leoItem(int set, int symbol);
+    bool buildSymbol(int symbol, int from, int to, ParseNode& node, vector<pair<int, pair<int, int> > >& active);
+    bool buildRule(int production, int dot, int from, int to, ParseNode& node,
+                   vector<pair<int, pair<int, int> > >& active);
+};
+
+/*
+ * Checks every sentence against the grammar's symbol on numThreads threads (0 means
+ * one per core), and returns the indices of the sentences it does not derive, in order.
+ */
+Vector<int> findRejectedSentences(const CompiledGrammar& grammar, const Vector<string>& sentences,
+                                  const string& symbol, int numThreads = 0);
+
+/*
+ * Return a parse tree in bracketed form, e.g. "(<s> (<np> (<pn> Fred)) (<vp> ...))".
+ */
+string parseTreeToString(const ParseNode& tree);
+
+#endif // _earleyparser_h
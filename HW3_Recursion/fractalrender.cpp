@@ -0,0 +1,491 @@
+//
+//  fractalrender.cpp
+//
+//  Created by Jian Zhong on 9/6/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#include "fractalrender.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "error.h"
+#include "filelib.h"
+#include "hashcode.h"
+#include "strlib.h"
+
+using namespace std;
+
+typedef void (*SegmentGenerator)(int width, int height, int order, double top, double bottom,
+                                 const SegmentSink& emit);
+
+// Function Prototypes (defined in fractals.cpp):
+Vector<int> setPalette();
+void mandelbrotRowIterations(double minX, double incX, double y, int startCol, int width,
+                             int maxIterations, int* iterations);
+void mandelbrotDeepZoomRows(const string& centerX, const string& centerY, double pixelSize, int maxIter,
+                            int width, int height, const function<void(int, const vector<int>&)>& emitRow);
+
+// Function Prototypes:
+long long floorDivide(long long a, long long b);
+string mandelbrotTileKey(double incX, double incY, int maxIter, const Vector<int>& palette,
+                         long long tileRow, long long tileCol);
+void renderMandelbrotTile(double incX, double incY, int maxIter, const Vector<int>& palette,
+                          long long tileRow, long long tileCol, vector<unsigned char>& rgb);
+bool loadTile(const string& fileName, const string& key, vector<unsigned char>& rgb);
+void saveTile(const string& fileName, const string& key, const vector<unsigned char>& rgb);
+void renderLinesToFile(const string& fileName, int width, int height, int order, SegmentGenerator generator);
+void rasterizeSegment(const LineSegment& segment, int top, int rows, int width, vector<unsigned char>& band);
+void sierpinskiBand(int width, int height, int order, double top, double bottom, const SegmentSink& emit);
+void treeBand(int width, int height, int order, double top, double bottom, const SegmentSink& emit);
+
+/*
+ * Writes an RGB image to a PPM or PNG file top to bottom, a band of rows at a time.
+ * The PNG is written with stored (uncompressed) deflate blocks, so no zlib is needed.
+ */
+class ImageFileWriter {
+public:
+    ImageFileWriter(const string& fileName, int width, int height);
+
+    /*
+     * Append numRows rows of width * 3 bytes (R, G, B) each.
+     */
+    void writeRows(const vector<unsigned char>& rgb, int numRows);
+
+    /*
+     * Finish the file; all height rows must have been written.
+     */
+    void close();
+
+private:
+    void writeChunk(const string& type, const vector<unsigned char>& data);
+    static uint32_t crc32(uint32_t crc, const unsigned char* data, size_t length);
+    static void appendBigEndian(vector<unsigned char>& out, uint32_t value);
+
+    ofstream out;
+    bool png;
+    int width;
+    int height;
+    int rowsWritten;
+    uint32_t adlerA;  // running Adler-32 of the zlib stream
+    uint32_t adlerB;
+};
+
+ImageFileWriter::ImageFileWriter(const string& fileName, int width, int height)
+    : width(width), height(height), rowsWritten(0), adlerA(1), adlerB(0) {
+    out.open(fileName, ios::binary);
+    if (out.fail()) error("Unable to open \"" + fileName + "\" for writing.");
+    png = endsWith(toLowerCase(fileName), ".png");
+
+    if (png) {
+        const unsigned char signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+        out.write((const char*) signature, 8);
+
+        vector<unsigned char> header;
+        appendBigEndian(header, width);
+        appendBigEndian(header, height);
+        header.push_back(8);   // bit depth
+        header.push_back(2);   // color type: RGB
+        header.push_back(0);   // compression: deflate
+        header.push_back(0);   // filter method
+        header.push_back(0);   // no interlace
+        writeChunk("IHDR", header);
+    } else {
+        out << "P6\n" << width << " " << height << "\n255\n";
+    }
+}
+
+void ImageFileWriter::writeRows(const vector<unsigned char>& rgb, int numRows) {
+    size_t rowBytes = (size_t) width * 3;
+
+    if (!png) {
+        out.write((const char*) rgb.data(), rowBytes * numRows);
+        rowsWritten += numRows;
+        return;
+    }
+
+    // one IDAT chunk per band; the zlib stream simply continues across chunks
+    vector<unsigned char> data;
+    if (rowsWritten == 0) {
+        data.push_back(0x78);  // zlib header: deflate, 32K window
+        data.push_back(0x01);
+    }
+
+    for (int r = 0; r < numRows; r++) {
+        rowsWritten++;
+        vector<unsigned char> line(1, 0); // filter type: none
+        line.insert(line.end(), rgb.begin() + r * rowBytes, rgb.begin() + (r + 1) * rowBytes);
+
+        // stored deflate blocks of at most 65535 bytes
+        for (size_t start = 0; start < line.size(); start += 65535) {
+            uint32_t length = min((size_t) 65535, line.size() - start);
+            bool last = rowsWritten == height && start + length == line.size();
+            data.push_back(last ? 1 : 0);
+            data.push_back(length & 0xff);
+            data.push_back(length >> 8);
+            data.push_back(~length & 0xff);
+            data.push_back((~length >> 8) & 0xff);
+            data.insert(data.end(), line.begin() + start, line.begin() + start + length);
+        }
+
+        for (unsigned char byte : line) {
+            adlerA = (adlerA + byte) % 65521;
+            adlerB = (adlerB + adlerA) % 65521;
+        }
+    }
+
+    if (rowsWritten == height) appendBigEndian(data, (adlerB << 16) | adlerA);
+    writeChunk("IDAT", data);
+}
+
+void ImageFileWriter::close() {
+    if (rowsWritten != height) error("Image closed before all rows were written.");
+    if (png) writeChunk("IEND", vector<unsigned char>());
+    out.close();
+}
+
+void ImageFileWriter::writeChunk(const string& type, const vector<unsigned char>& data) {
+    vector<unsigned char> length;
+    appendBigEndian(length, data.size());
+    out.write((const char*) length.data(), 4);
+    out.write(type.c_str(), 4);
+    out.write((const char*) data.data(), data.size());
+
+    uint32_t crc = crc32(0xffffffff, (const unsigned char*) type.c_str(), 4);
+    crc = crc32(crc, data.data(), data.size()) ^ 0xffffffff;
+    vector<unsigned char> crcBytes;
+    appendBigEndian(crcBytes, crc);
+    out.write((const char*) crcBytes.data(), 4);
+}
+
+uint32_t ImageFileWriter::crc32(uint32_t crc, const unsigned char* data, size_t length) {
+    static uint32_t table[256];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        tableReady = true;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+void ImageFileWriter::appendBigEndian(vector<unsigned char>& out, uint32_t value) {
+    out.push_back(value >> 24);
+    out.push_back((value >> 16) & 0xff);
+    out.push_back((value >> 8) & 0xff);
+    out.push_back(value & 0xff);
+}
+
+
+/**
+ ******************************** Mandelbrot Set ******************************************
+ * Tiles live on a global pixel lattice: global pixel (R, C) is the point (C*incX, R*incY)
+ * and tile (tileRow, tileCol) covers RENDER_TILE_SIZE rows and columns of it. Every image
+ * at the same scale shares the lattice, so panned and repeated renders reuse cached tiles.
+ * **************************************************************************************
+ */
+void renderMandelbrotToFile(const string& fileName, int width, int height,
+                            double minX, double incX, double minY, double incY,
+                            int maxIter, const string& cacheDir) {
+    const int T = RENDER_TILE_SIZE;
+    Vector<int> palette = setPalette();
+    if (!cacheDir.empty()) createDirectoryPath(cacheDir);
+
+    long long originCol = llround(minX / incX);  // global column of image column 0
+    long long originRow = llround(minY / incY);  // global row of image row 0
+    ImageFileWriter writer(fileName, width, height);
+    vector<unsigned char> tile;
+
+    // one band per tile row of the lattice that the image crosses
+    for (long long gRow = originRow; gRow < originRow + height; ) {
+        long long tileRow = floorDivide(gRow, T);
+        long long bandEnd = min((tileRow + 1) * T, originRow + height);
+        int bandRows = bandEnd - gRow;
+        vector<unsigned char> band((size_t) width * bandRows * 3);
+
+        for (long long gCol = originCol; gCol < originCol + width; ) {
+            long long tileCol = floorDivide(gCol, T);
+            long long colEnd = min((tileCol + 1) * T, originCol + width);
+
+            // find the tile in the cache, or render it and add it
+            string key = mandelbrotTileKey(incX, incY, maxIter, palette, tileRow, tileCol);
+            ostringstream tileName;
+            tileName << cacheDir << "/" << hex << hashCode(key) << ".tile";
+            if (cacheDir.empty() || !loadTile(tileName.str(), key, tile)) {
+                renderMandelbrotTile(incX, incY, maxIter, palette, tileRow, tileCol, tile);
+                if (!cacheDir.empty()) saveTile(tileName.str(), key, tile);
+            }
+
+            // copy the part of the tile that falls inside this band of the image
+            for (int r = 0; r < bandRows; r++) {
+                size_t tileOffset = ((size_t) (gRow - tileRow * T + r) * T + (gCol - tileCol * T)) * 3;
+                size_t bandOffset = ((size_t) r * width + (gCol - originCol)) * 3;
+                copy(tile.begin() + tileOffset, tile.begin() + tileOffset + (colEnd - gCol) * 3,
+                     band.begin() + bandOffset);
+            }
+            gCol = colEnd;
+        }
+
+        writer.writeRows(band, bandRows);
+        gRow = bandEnd;
+    }
+    writer.close();
+}
+
+/**
+ ******************************** Deep Zoom Mandelbrot Set *******************************
+ * Same perturbation method as mandelbrotDeepZoom; rows are colored with the palette and
+ * written a band at a time as they are finished. Nothing is cached.
+ * **************************************************************************************
+ */
+void renderMandelbrotDeepZoomToFile(const string& fileName, int width, int height,
+                                    const string& centerX, const string& centerY,
+                                    double pixelSize, int maxIter) {
+    Vector<int> palette = setPalette();
+    ImageFileWriter writer(fileName, width, height);
+    vector<unsigned char> band;
+
+    mandelbrotDeepZoomRows(centerX, centerY, pixelSize, maxIter, width, height,
+                           [&](int row, const vector<int>& rowIterations) {
+        for (int c = 0; c < width; c++) {
+            int color = palette[rowIterations[c] % palette.size()];
+            band.push_back((color >> 16) & 0xff);
+            band.push_back((color >> 8) & 0xff);
+            band.push_back(color & 0xff);
+        }
+        if (row % RENDER_TILE_SIZE == RENDER_TILE_SIZE - 1 || row == height - 1) {
+            writer.writeRows(band, band.size() / (width * 3));
+            band.clear();
+        }
+    });
+    writer.close();
+}
+
+/// Floor division, so that negative lattice coordinates map to the right tile.
+long long floorDivide(long long a, long long b) {
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+/// Cache key of a tile: everything its pixels depend on, with the doubles in exact hex form.
+string mandelbrotTileKey(double incX, double incY, int maxIter, const Vector<int>& palette,
+                         long long tileRow, long long tileCol) {
+    ostringstream key;
+    key << "mandelbrot " << hexfloat << incX << " " << incY << defaultfloat
+        << " maxIter=" << maxIter << " palette=" << hex;
+    for (int color : palette) key << color << ",";
+    key << dec << " tile=" << tileRow << "," << tileCol << " size=" << RENDER_TILE_SIZE;
+    return key.str();
+}
+
+/// Renders one RENDER_TILE_SIZE square tile of the lattice as RGB bytes.
+void renderMandelbrotTile(double incX, double incY, int maxIter, const Vector<int>& palette,
+                          long long tileRow, long long tileCol, vector<unsigned char>& rgb) {
+    const int T = RENDER_TILE_SIZE;
+    rgb.assign((size_t) T * T * 3, 0);
+    Vector<int> rowIterations(T);
+    double tileX = (double) (tileCol * T) * incX;  // real part of the tile's first column
+
+    for (int r = 0; r < T; r++) {
+        double y = (double) (tileRow * T + r) * incY;
+        mandelbrotRowIterations(tileX, incX, y, 0, T, maxIter, &rowIterations[0]);
+        for (int c = 0; c < T; c++) {
+            int color = palette[rowIterations[c] % palette.size()];
+            size_t offset = ((size_t) r * T + c) * 3;
+            rgb[offset] = (color >> 16) & 0xff;
+            rgb[offset + 1] = (color >> 8) & 0xff;
+            rgb[offset + 2] = color & 0xff;
+        }
+    }
+}
+
+/// Reads a cached tile; false if it is missing or was stored under a different key.
+bool loadTile(const string& fileName, const string& key, vector<unsigned char>& rgb) {
+    ifstream input(fileName, ios::binary);
+    if (input.fail()) return false;
+
+    string storedKey;
+    if (!getline(input, storedKey) || storedKey != key) return false; // hash collision
+
+    rgb.resize((size_t) RENDER_TILE_SIZE * RENDER_TILE_SIZE * 3);
+    input.read((char*) rgb.data(), rgb.size());
+    return input.gcount() == (streamsize) rgb.size();
+}
+
+/// Writes a tile to the cache: its key on the first line, then the RGB bytes.
+void saveTile(const string& fileName, const string& key, const vector<unsigned char>& rgb) {
+    // write to a temporary name first so a half-written tile is never picked up
+    string tempName = fileName + ".tmp";
+    ofstream output(tempName, ios::binary);
+    if (output.fail()) return; // the cache is optional
+    output << key << "\n";
+    output.write((const char*) rgb.data(), rgb.size());
+    output.close();
+    rename(tempName.c_str(), fileName.c_str());
+}
+
+
+/**
+ ******************************** Sierpinski / Tree *************************************
+ * Line fractals are regenerated for every band of rows, skipping the parts that cannot
+ * cross the band, and rasterized 1 pixel wide on a white background.
+ * **************************************************************************************
+ */
+void renderSierpinskiToFile(const string& fileName, int width, int height, int order) {
+    renderLinesToFile(fileName, width, height, order, sierpinskiBand);
+}
+
+void renderTreeToFile(const string& fileName, int width, int height, int order) {
+    renderLinesToFile(fileName, width, height, order, treeBand);
+}
+
+void renderLinesToFile(const string& fileName, int width, int height, int order, SegmentGenerator generator) {
+    ImageFileWriter writer(fileName, width, height);
+
+    for (int top = 0; top < height; top += RENDER_TILE_SIZE) {
+        int rows = min(RENDER_TILE_SIZE, height - top);
+        vector<unsigned char> band((size_t) width * rows * 3, 0xff);
+
+        // lines are drawn as they are generated, so they never pile up in memory
+        generator(width, height, order, top - 1, top + rows, [&](const LineSegment& segment) {
+            rasterizeSegment(segment, top, rows, width, band);
+        });
+
+        writer.writeRows(band, rows);
+    }
+    writer.close();
+}
+
+/// Draws the part of a line that falls on rows [top, top + rows) into a band, one pixel per step.
+void rasterizeSegment(const LineSegment& segment, int top, int rows, int width, vector<unsigned char>& band) {
+    double dx = segment.x1 - segment.x0;
+    double dy = segment.y1 - segment.y0;
+    int steps = max(1, (int) ceil(max(fabs(dx), fabs(dy))));
+
+    // clip the line parameter t to the band's rows
+    double t0 = 0, t1 = 1;
+    if (dy != 0) {
+        double ta = (top - 0.5 - segment.y0) / dy;
+        double tb = (top + rows - 0.5 - segment.y0) / dy;
+        t0 = max(t0, min(ta, tb));
+        t1 = min(t1, max(ta, tb));
+        if (t0 > t1) return;
+    }
+
+    for (int i = (int) floor(t0 * steps); i <= (int) ceil(t1 * steps); i++) {
+        double t = (double) i / steps;
+        long px = lround(segment.x0 + dx * t);
+        long py = lround(segment.y0 + dy * t) - top;
+        if (px < 0 || px >= width || py < 0 || py >= rows) continue;
+
+        size_t offset = ((size_t) py * width + px) * 3;
+        band[offset] = (segment.color >> 16) & 0xff;
+        band[offset + 1] = (segment.color >> 8) & 0xff;
+        band[offset + 2] = segment.color & 0xff;
+    }
+}
+
+/// Sierpinski triangle as wide as the image (or as tall, if that is smaller).
+void sierpinskiBand(int width, int height, int order, double top, double bottom, const SegmentSink& emit) {
+    double size = min((double) width, height / (sqrt(3)/2)) - 1;
+    sierpinskiSegments(0, 0, size, order, top, bottom, 2, emit);
+}
+
+/// Recursive tree in the largest centered square of the image; branches under 2 pixels
+/// only smear into their neighbors, so they are drawn as dots.
+void treeBand(int width, int height, int order, double top, double bottom, const SegmentSink& emit) {
+    double size = min(width, height);
+    treeSegments((width - size) / 2, (height - size) / 2, size, order, top, bottom, 2, emit);
+}
+
+
+#ifdef FRACTAL_RENDER_MAIN
+/*
+ * Times mandelbrotRowIterations on whole rows (the AVX2 kernel, if built with -mavx2 or
+ * -march=native) against one pixel at a time (always the scalar kernel) on a view of the
+ * whole set, and checks that every pixel gets the same iteration count from both.
+ */
+void benchmarkMandelbrot(int width, int height, int maxIter) {
+    double inc = 3.5 / width;
+    double minX = -2.5, minY = -inc * height / 2;
+    vector<int> rowIterations(width), scalarIterations(width);
+    long long mismatches = 0;
+    double rowSeconds = 0, scalarSeconds = 0;
+
+    for (int r = 0; r < height; r++) {
+        double y = minY + r * inc;
+        auto startTime = chrono::steady_clock::now();
+        mandelbrotRowIterations(minX, inc, y, 0, width, maxIter, &rowIterations[0]);
+        auto rowTime = chrono::steady_clock::now();
+        for (int c = 0; c < width; c++) {
+            mandelbrotRowIterations(minX, inc, y, c, 1, maxIter, &scalarIterations[c]);
+        }
+        auto scalarTime = chrono::steady_clock::now();
+        rowSeconds += chrono::duration<double>(rowTime - startTime).count();
+        scalarSeconds += chrono::duration<double>(scalarTime - rowTime).count();
+
+        for (int c = 0; c < width; c++) {
+            if (rowIterations[c] != scalarIterations[c]) mismatches++;
+        }
+    }
+
+    cout << width << "x" << height << ", maxIter " << maxIter << ": rows " << rowSeconds
+         << " s, single pixels " << scalarSeconds << " s (" << scalarSeconds / rowSeconds << "x), "
+         << mismatches << " pixels differ" << endl;
+}
+
+/*
+ * Standalone renderer, built separately from the GUI with -DFRACTAL_RENDER_MAIN:
+ *
+ *     fractalrender mandelbrot <width> <height> <out.png|out.ppm> <minX> <incX> <minY> <incY> <maxIter> [cacheDir]
+ *     fractalrender deepzoom   <width> <height> <out.png|out.ppm> <centerX> <centerY> <pixelSize> <maxIter>
+ *     fractalrender sierpinski <width> <height> <out.png|out.ppm> <order>
+ *     fractalrender tree       <width> <height> <out.png|out.ppm> <order>
+ *     fractalrender bench      <width> <height> <maxIter>
+ */
+int main(int argc, char** argv) {
+    if (argc == 5 && string(argv[1]) == "bench") {
+        benchmarkMandelbrot(stringToInteger(argv[2]), stringToInteger(argv[3]), stringToInteger(argv[4]));
+        return 0;
+    }
+    if (argc < 6) {
+        cerr << "usage: " << argv[0] << " mandelbrot|deepzoom|sierpinski|tree <width> <height> <file> ..." << endl;
+        cerr << "       " << argv[0] << " bench <width> <height> <maxIter>" << endl;
+        return 1;
+    }
+
+    string fractal = argv[1];
+    int width = stringToInteger(argv[2]);
+    int height = stringToInteger(argv[3]);
+    string fileName = argv[4];
+
+    if (fractal == "mandelbrot" && argc >= 10) {
+        renderMandelbrotToFile(fileName, width, height,
+                               stringToReal(argv[5]), stringToReal(argv[6]),
+                               stringToReal(argv[7]), stringToReal(argv[8]),
+                               stringToInteger(argv[9]), argc >= 11 ? argv[10] : "");
+    } else if (fractal == "deepzoom" && argc >= 9) {
+        renderMandelbrotDeepZoomToFile(fileName, width, height, argv[5], argv[6],
+                                       stringToReal(argv[7]), stringToInteger(argv[8]));
+    } else if (fractal == "sierpinski") {
+        renderSierpinskiToFile(fileName, width, height, stringToInteger(argv[5]));
+    } else if (fractal == "tree") {
+        renderTreeToFile(fileName, width, height, stringToInteger(argv[5]));
+    } else {
+        cerr << "Unknown fractal or missing arguments: " << fractal << endl;
+        return 1;
+    }
+    return 0;
+}
+#endif // FRACTAL_RENDER_MAIN
@@ -0,0 +1,86 @@
+//
+//  fractalrender.h
+//
+//  Headless rendering of the fractals straight into PPM or PNG files of any
+//  resolution. Images are produced in horizontal bands, so memory use depends
+//  on the image width, not on the whole framebuffer.
+//
+//  Created by Jian Zhong on 9/6/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#ifndef _fractalrender_h
+#define _fractalrender_h
+
+#include <functional>
+#include <string>
+
+using namespace std;
+
+class GWindow;
+
+// Side of a square Mandelbrot tile, also the height of a band of output rows.
+const int RENDER_TILE_SIZE = 256;
+
+/* A line of a line-drawn fractal, in pixel coordinates */
+struct LineSegment {
+    double x0, y0;
+    double x1, y1;
+    int color;
+};
+
+/* Receives each line of a line fractal as it is generated */
+typedef function<void(const LineSegment& segment)> SegmentSink;
+
+/*
+ * Emits the lines of a Sierpinski triangle (same geometry as drawSierpinskiTriangle)
+ * that may cross rows [top, bottom]. Triangles smaller than minSize are drawn whole
+ * instead of being subdivided further.
+ */
+void sierpinskiSegments(double x, double y, double size, int order,
+                        double top, double bottom, double minSize, const SegmentSink& emit);
+
+/*
+ * Emits the branches of a recursive tree (same geometry as drawTree) that may cross
+ * rows [top, bottom]. A branch shorter than minLength stands for its whole subtree and
+ * is drawn as a single dot at its base.
+ */
+void treeSegments(double x, double y, double size, int order,
+                  double top, double bottom, double minLength, const SegmentSink& emit);
+
+/*
+ * Renders a Mandelbrot view to fileName (".png" for PNG, PPM otherwise). Pixel (r, c)
+ * is the point (minX + c*incX, minY + r*incY) snapped to the incX/incY lattice, so
+ * panned views share tiles. Finished tiles are kept in cacheDir, keyed by view scale,
+ * maxIter, palette and tile position; an empty cacheDir disables the cache.
+ */
+void renderMandelbrotToFile(const string& fileName, int width, int height,
+                            double minX, double incX, double minY, double incY,
+                            int maxIter, const string& cacheDir);
+
+/*
+ * Draws a deep zoom of the Mandelbrot set in gw, centered on the point (centerX, centerY)
+ * given as decimal strings, with pixels pixelSize apart; pixel sizes down to about 1e-130
+ * still resolve. Colored like mandelbrotSet; defined in fractals.cpp.
+ */
+void mandelbrotDeepZoom(GWindow& gw, const string& centerX, const string& centerY,
+                        double pixelSize, int maxIter, int color);
+
+/*
+ * Renders the same deep zoom as mandelbrotDeepZoom to fileName, with the palette.
+ */
+void renderMandelbrotDeepZoomToFile(const string& fileName, int width, int height,
+                                    const string& centerX, const string& centerY,
+                                    double pixelSize, int maxIter);
+
+/*
+ * Renders a Sierpinski triangle filling the image width to fileName.
+ */
+void renderSierpinskiToFile(const string& fileName, int width, int height, int order);
+
+/*
+ * Renders a recursive tree filling the image to fileName.
+ */
+void renderTreeToFile(const string& fileName, int width, int height, int order);
+
+#endif // _fractalrender_h
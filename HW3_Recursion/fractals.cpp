@@ -7,14 +7,95 @@
 
 
 #include "fractals.h"
+#include <algorithm>
+#include <climits>
 #include <cmath>
+#include <functional>
+#include <vector>
 #include "gbufferedimage.h"
+#include "bigfixed.h"
+#include "fractalrender.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Round every product on its own, never fused into an FMA with the following add, so
+// that the scalar kernel and the AVX2 kernel give identical iteration counts whatever
+// -ffp-contract or -march the file is built with.
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
 
 using namespace std;
 
 const int LEAF_COLOR = 0x2e8b57;   /* Color of all leaves of recursive tree (level 1) */
 const int BRANCH_COLOR = 0x8b7765; /* Color of all branches of recursive tree (level >=2) */
 
+/* Z.abs() > 4 compared on the squared magnitude: sqrt(s) > 4 holds exactly when s is
+ * above the next double after 16, so this threshold keeps iteration counts identical. */
+static const double ESCAPE_RADIUS_SQUARED = nextafter(16.0, 17.0);
+
+const int NOT_COMPUTED = -1;   /* Iteration count of a pixel that has not been computed yet */
+const int PREVIEW_BLOCK = 8;   /* Side of the pixel blocks shown by the coarse Mandelbrot preview */
+const int REFINE_BAND = 64;    /* Rows refined (and shown) at a time after the preview */
+const int MIN_SUBDIVIDE = 6;   /* Rectangles this small are computed pixel by pixel */
+const double SERIES_TOLERANCE = 1e-6; /* Largest relative size of the dropped series term */
+const int TREE_DIRECTIONS = 24;       /* Tree branches point at multiples of 15 degrees */
+const double MIN_BRANCH_LENGTH = 1.0; /* Shorter tree branches are culled from the display list */
+
+/* Series approximation of a perturbed orbit: delta = A*dc + B*dc^2 + C*dc^3 after skip iterations */
+struct SeriesTerms {
+    double ar, ai;
+    double br, bi;
+    double cr, ci;
+    int skip;
+};
+
+/* Flat display list of a recursive tree, level by level: the seven children of segment i
+ * of a level are segments 7i .. 7i+6 of the next level, and each segment starts at its
+ * parent's tip, so only tips and directions are stored */
+struct TreeDisplayList {
+    double baseX, baseY;              // bottom of the trunk
+    std::vector<float> tipX, tipY;    // tip of every segment
+    std::vector<unsigned char> direction; // direction of every segment, in 15 degree steps
+    Vector<int> levelStart;           // first segment of every level, plus the total count
+};
+
+/* The pixel-to-plane mapping of one Mandelbrot render */
+struct MandelbrotView {
+    double minX;
+    double incX;
+    double minY;
+    double incY;
+    int maxIter;
+};
+
+// Function Prototypes:
+int mandelbrotIterations(double zr, double zi, double cr, double ci, int maxIterations, int numIterations);
+bool inMainCardioidOrBulb(double cr, double ci);
+void mandelbrotRowIterations(double minX, double incX, double y, int startCol, int width,
+                             int maxIterations, int* iterations);
+int mandelbrotPixel(const MandelbrotView& view, Grid<int>& iterations, int row, int col);
+void mandelbrotRowSpan(const MandelbrotView& view, Grid<int>& iterations, int row, int left, int right);
+void marianiSilver(const MandelbrotView& view, Grid<int>& iterations, int top, int left, int bottom, int right);
+void colorPixels(Grid<int>& pixels, const Grid<int>& iterations, int top, int bottom,
+                 int maxIter, int color, const Vector<int>& palette);
+void mandelbrotReferenceOrbit(const BigFixed& cr, const BigFixed& ci, int maxIter,
+                              Vector<double>& refR, Vector<double>& refI);
+SeriesTerms mandelbrotSeries(const Vector<double>& refR, const Vector<double>& refI,
+                             double maxDelta, int maxIter);
+int perturbedIterations(const Vector<double>& refR, const Vector<double>& refI, const SeriesTerms& series,
+                        double dcr, double dci, int maxIter);
+void mandelbrotDeepZoomRows(const string& centerX, const string& centerY, double pixelSize, int maxIter,
+                            int width, int height, const function<void(int, const vector<int>&)>& emitRow);
+void treeDirection(int direction, double& dx, double& dy);
+void buildTreeDisplayList(double size, int order, TreeDisplayList& list);
+void drawLineOnGrid(Grid<int>& pixels, double x0, double y0, double x1, double y1, int color);
+void treeSegmentsHelper(double x, double y, double length, int order, int direction,
+                        double top, double bottom, double minLength, const SegmentSink& emit);
+
 /**
  ******************************** HW 3.1 Sierpinski **************************************
  * Draws a Sierpinski triangle of the specified size and order, placing its
@@ -63,34 +144,190 @@ void drawSierpinskiTriangle(GWindow& gw, double x, double y, double size, int or
  * @param y - The y coordinate of the top-left corner of the "bounding box". // 650
  * @param size - The length of one side of the bounding box. // 650
  * @param order - The order of the fractal.
+ *
+ * The tree is generated level by level into a flat display list (7^level segments per
+ * level, no recursion), branches shorter than a pixel are culled, and the list is
+ * rasterized into one image that goes to the window in a single draw.
  * **************************************************************************************
  */
-void drawTreeHelper(GWindow& gw, double x, double y, double size, int order, int angle) {
+void drawTree(GWindow& gw, double x, double y, double size, int order) {
     if (order < 0) {
         error("*** Invalid input: order should be >= 0. ***");
-    } else if (order != 0) {
+    }
 
-        // Set color
-        if (order == 1) {         // the outter most area
-            gw.setColor(LEAF_COLOR);
-        } else {                  // NOT outter most area
-            gw.setColor(BRANCH_COLOR);
+    // generate the whole tree into a flat display list
+    TreeDisplayList list;
+    buildTreeDisplayList(size, order, list);
+    int levels = list.levelStart.size() - 1;
+
+    // rasterize it into the pixels of the bounding box
+    int side = (int) ceil(size) + 1;
+    GBufferedImage image(side, side, 0xffffff);
+    gw.add(&image, x, y);
+    Grid<int> pixels = image.toGrid();
+
+    for (int level = 0; level < levels; level++) {
+        int color = (level == order - 1) ? LEAF_COLOR : BRANCH_COLOR;
+        for (int i = list.levelStart[level]; i < list.levelStart[level + 1]; i++) {
+            // the trunk starts at the base, every other segment at its parent's tip
+            int parent = (level == 0) ? -1 : list.levelStart[level - 1] + (i - list.levelStart[level]) / 7;
+            double startX = (parent < 0) ? list.baseX : list.tipX[parent];
+            double startY = (parent < 0) ? list.baseY : list.tipY[parent];
+            drawLineOnGrid(pixels, startX, startY, list.tipX[i], list.tipY[i], color);
         }
+    }
 
-        // Draw tree trunk and get the trunk's tip
-        GPoint tip = gw.drawPolarLine(x, y, size, angle);
+    // culled levels: all of a last-level segment's sub-pixel children share one dot
+    if (levels > 0 && levels < order) {
+        for (int i = list.levelStart[levels - 1]; i < list.levelStart[levels]; i++) {
+            drawLineOnGrid(pixels, list.tipX[i], list.tipY[i], list.tipX[i], list.tipY[i], LEAF_COLOR);
+        }
+    }
 
-        // Recursive Case: while NOT leaf, draw branches by recursion:
-        int j = 45;
-        for (int i = 0; i < 7; i++) {
-            drawTreeHelper(gw, tip.getX(), tip.getY(), size/2, order-1, angle-90+j);  // angle-90+j: 15, 30, 45, 60, 75, 90, 105
-            j += 15;
+    image.fromGrid(pixels); // draw the whole tree at once
+}
+
+/// Builds the display list of a tree in a size x size box with (0, 0) at its top-left corner,
+/// one level at a time, stopping at order levels or when branches get under MIN_BRANCH_LENGTH.
+void buildTreeDisplayList(double size, int order, TreeDisplayList& list) {
+    list.baseX = size/2;
+    list.baseY = size;
+
+    // count the levels that are drawn, so the buffers are allocated once
+    int levels = 0;
+    long long total = 0;
+    long long levelCount = 1;
+    list.levelStart.add(0);
+    for (double length = size/2; levels < order && length >= MIN_BRANCH_LENGTH; length /= 2) {
+        // segments are numbered with ints, so the levels that are drawn must fit in one
+        if (total + levelCount > INT_MAX) {
+            error("*** Invalid input: the tree has too many branches to draw at this order and size. ***");
+        }
+        levels++;
+        total += levelCount;
+        list.levelStart.add(total);
+        levelCount *= 7;
+    }
+    list.tipX.resize(total);
+    list.tipY.resize(total);
+    list.direction.resize(total);
+    if (total == 0) return;
+
+    // trunk: straight up
+    double length = size/2;
+    double dx, dy;
+    list.direction[0] = 6;   // 90 degrees
+    treeDirection(6, dx, dy);
+    list.tipX[0] = list.baseX + length * dx;
+    list.tipY[0] = list.baseY + length * dy;
+
+    // every other level: seven children per parent, at -45 .. +45 degrees from it
+    for (int level = 1; level < levels; level++) {
+        length /= 2;
+        int i = list.levelStart[level];
+        for (int parent = list.levelStart[level - 1]; parent < list.levelStart[level]; parent++) {
+            for (int branch = 0; branch < 7; branch++, i++) {
+                int direction = (list.direction[parent] - 3 + branch + TREE_DIRECTIONS) % TREE_DIRECTIONS;
+                treeDirection(direction, dx, dy);
+                list.direction[i] = direction;
+                list.tipX[i] = list.tipX[parent] + length * dx;
+                list.tipY[i] = list.tipY[parent] + length * dy;
+            }
         }
     }
 }
 
-void drawTree(GWindow& gw, double x, double y, double size, int order) {
-    drawTreeHelper(gw, x + size/2, y + size, size / 2, order, 90);
+/// Unit step of a branch pointing at direction * 15 degrees, y growing downward as in
+/// drawPolarLine; the sines and cosines are computed once, by whichever thread gets
+/// here first (a function-local static is initialized thread-safely).
+void treeDirection(int direction, double& dx, double& dy) {
+    struct DirectionTable {
+        double cos[TREE_DIRECTIONS];
+        double sin[TREE_DIRECTIONS];
+    };
+    static const DirectionTable table = [] {
+        DirectionTable built;
+        double step = acos(-1.0) / 12;  // 15 degrees in radians
+        for (int i = 0; i < TREE_DIRECTIONS; i++) {
+            built.cos[i] = cos(i * step);
+            built.sin[i] = -sin(i * step);
+        }
+        return built;
+    }();
+    dx = table.cos[direction];
+    dy = table.sin[direction];
+}
+
+/// Draws a 1-pixel line into a grid of pixels, skipping the parts outside it.
+void drawLineOnGrid(Grid<int>& pixels, double x0, double y0, double x1, double y1, int color) {
+    double dx = x1 - x0;
+    double dy = y1 - y0;
+    int steps = max(1, (int) ceil(max(fabs(dx), fabs(dy))));
+    double stepX = dx / steps;
+    double stepY = dy / steps;
+
+    double x = x0 + 0.5;   // +0.5 so truncating rounds to the nearest pixel
+    double y = y0 + 0.5;
+    for (int i = 0; i <= steps; i++, x += stepX, y += stepY) {
+        int c = (int) floor(x);
+        int r = (int) floor(y);
+        if (pixels.inBounds(r, c)) pixels[r][c] = color;
+    }
+}
+
+/// Lines of a Sierpinski triangle for the headless renderer, clipped to a band of rows.
+void sierpinskiSegments(double x, double y, double size, int order,
+                        double top, double bottom, double minSize, const SegmentSink& emit) {
+    if (order <= 0) return;
+
+    double height = (sqrt(3)/2) * size;
+    if (y > bottom || y + height < top) return; // whole triangle is outside the band
+
+    if (order == 1 || size < minSize) {
+        // same three lines as drawATriangle
+        emit({x,            y,          x + size,     y,          0x000000});
+        emit({x + size,     y,          x + (size/2), y + height, 0x000000});
+        emit({x + (size/2), y + height, x,            y,          0x000000});
+    } else {
+        sierpinskiSegments(x,          y,            size/2, order-1, top, bottom, minSize, emit);
+        sierpinskiSegments(x+(size/2), y,            size/2, order-1, top, bottom, minSize, emit);
+        sierpinskiSegments(x+(size/4), y + height/2, size/2, order-1, top, bottom, minSize, emit);
+    }
+}
+
+/// Branches of a recursive tree for the headless renderer, clipped to a band of rows.
+void treeSegments(double x, double y, double size, int order,
+                  double top, double bottom, double minLength, const SegmentSink& emit) {
+    treeSegmentsHelper(x + size/2, y + size, size/2, order, 6, top, bottom, minLength, emit);
+}
+
+void treeSegmentsHelper(double x, double y, double length, int order, int direction,
+                        double top, double bottom, double minLength, const SegmentSink& emit) {
+    if (order <= 0) return;
+
+    // a subtree stays within 2 * length of its base (length + length/2 + ...)
+    if (y - 2*length > bottom || y + 2*length < top) return;
+
+    int color = (order == 1) ? LEAF_COLOR : BRANCH_COLOR;
+    if (length < minLength) {
+        emit({x, y, x, y, LEAF_COLOR}); // sub-pixel subtree: a single dot
+        return;
+    }
+
+    double dx, dy;
+    treeDirection(direction, dx, dy);
+    double tipX = x + length * dx;
+    double tipY = y + length * dy;
+    emit({x, y, tipX, tipY, color});
+
+    if (order > 1 && length/2 < minLength) {
+        emit({tipX, tipY, tipX, tipY, LEAF_COLOR}); // all seven sub-pixel children share one dot
+        return;
+    }
+    for (int i = 0; i < 7; i++) {
+        treeSegmentsHelper(tipX, tipY, length/2, order-1, (direction - 3 + i + TREE_DIRECTIONS) % TREE_DIRECTIONS,
+                           top, bottom, minLength, emit);
+    }
 }
 
 /**
@@ -120,35 +357,292 @@ void mandelbrotSet(GWindow& gw, double minX, double incX,
     gw.add(&image);                                // add image into (leftX, topY)
     Grid<int> pixels = image.toGrid();             // Convert the entire image to pixels in Gird collection
 
-    // traverse all pixels in the canvas
-    for (int c = 0; c < pixels.numCols(); c++) {
-        for (int r = 0; r < pixels.numRows(); r++) {
+    MandelbrotView view = {minX, incX, minY, incY, maxIter};
+    int rows = pixels.numRows();
+    int cols = pixels.numCols();
+    Grid<int> iterations(rows, cols, NOT_COMPUTED); // iteration count of every pixel
 
-            // Draw pixel in M set
-            int numIterations = mandelbrotSetIterations(Complex(minX + c*incX, minY + r*incY), maxIter);
-            if (color != 0) { // if color is non-zero, set as int color.
-                if (numIterations == maxIter) {
-                    pixels[r][c] = color;  // C is in M set, draw the pixel
+    // Pass 1: coarse preview, one computed pixel per PREVIEW_BLOCK x PREVIEW_BLOCK block
+    for (int r = 0; r < rows; r += PREVIEW_BLOCK) {
+        for (int c = 0; c < cols; c += PREVIEW_BLOCK) {
+            int numIterations = mandelbrotPixel(view, iterations, r, c);
+            int blockColor = (color != 0) ? (numIterations == maxIter ? color : 0xffffff)
+                                          : palette[numIterations % palette.size()];
+            for (int br = r; br < r + PREVIEW_BLOCK && br < rows; br++) {
+                for (int bc = c; bc < c + PREVIEW_BLOCK && bc < cols; bc++) {
+                    pixels[br][bc] = blockColor;
                 }
+            }
+        }
+    }
+    image.fromGrid(pixels); // show the preview right away
+
+    // Pass 2: refine a band of rows at a time by Mariani-Silver subdivision
+    for (int top = 0; top < rows; top += REFINE_BAND) {
+        int bottom = min(top + REFINE_BAND, rows) - 1;
+        marianiSilver(view, iterations, top, 0, bottom, cols - 1);
+        colorPixels(pixels, iterations, top, bottom, maxIter, color, palette);
+        image.fromGrid(pixels); // Converts and puts the grid back into the image onscreen
+    }
+}
+
+/// Mariani-Silver subdivision: computes the border of a rectangle (inclusive bounds); if every
+/// border pixel has the same iteration count, the inside is filled with it without computing it,
+/// otherwise the rectangle is split in two along its longer side and each half is refined.
+void marianiSilver(const MandelbrotView& view, Grid<int>& iterations, int top, int left, int bottom, int right) {
+    // compute the border
+    mandelbrotRowSpan(view, iterations, top, left, right);
+    mandelbrotRowSpan(view, iterations, bottom, left, right);
+    for (int r = top + 1; r < bottom; r++) {
+        mandelbrotPixel(view, iterations, r, left);
+        mandelbrotPixel(view, iterations, r, right);
+    }
+
+    if (bottom - top < 2 || right - left < 2) return; // no inside left to fill
+
+    // check if the border is uniform
+    int borderIterations = iterations[top][left];
+    bool uniform = true;
+    for (int c = left; c <= right && uniform; c++) {
+        uniform = iterations[top][c] == borderIterations && iterations[bottom][c] == borderIterations;
+    }
+    for (int r = top + 1; r < bottom && uniform; r++) {
+        uniform = iterations[r][left] == borderIterations && iterations[r][right] == borderIterations;
+    }
+
+    if (uniform) {
+        // fill the inside without computing it
+        for (int r = top + 1; r < bottom; r++) {
+            for (int c = left + 1; c < right; c++) {
+                iterations[r][c] = borderIterations;
+            }
+        }
+    } else if (bottom - top < MIN_SUBDIVIDE && right - left < MIN_SUBDIVIDE) {
+        // too small to be worth splitting: compute the inside directly
+        for (int r = top + 1; r < bottom; r++) {
+            mandelbrotRowSpan(view, iterations, r, left + 1, right - 1);
+        }
+    } else if (right - left >= bottom - top) {
+        // split the columns; both halves share the middle column
+        int mid = (left + right) / 2;
+        marianiSilver(view, iterations, top, left, bottom, mid);
+        marianiSilver(view, iterations, top, mid, bottom, right);
+    } else {
+        // split the rows; both halves share the middle row
+        int mid = (top + bottom) / 2;
+        marianiSilver(view, iterations, top, left, mid, right);
+        marianiSilver(view, iterations, mid, left, bottom, right);
+    }
+}
+
+/// Returns the iteration count of pixel [row][col], computing it only if not already known.
+int mandelbrotPixel(const MandelbrotView& view, Grid<int>& iterations, int row, int col) {
+    if (iterations[row][col] == NOT_COMPUTED) {
+        double cr = view.minX + col*view.incX;
+        double ci = view.minY + row*view.incY;
+        iterations[row][col] = inMainCardioidOrBulb(cr, ci) ? view.maxIter
+                                                            : mandelbrotIterations(0, 0, cr, ci, view.maxIter, 0);
+    }
+    return iterations[row][col];
+}
+
+/// Computes the missing iteration counts of columns [left, right] of a row, each run of
+/// uncomputed pixels going through the row kernel at once.
+void mandelbrotRowSpan(const MandelbrotView& view, Grid<int>& iterations, int row, int left, int right) {
+    Vector<int> runIterations(right - left + 1);
+    double y = view.minY + row*view.incY;
+
+    int c = left;
+    while (c <= right) {
+        if (iterations[row][c] != NOT_COMPUTED) {
+            c++;
+            continue;
+        }
+
+        // find the run of uncomputed pixels starting at c
+        int runEnd = c;
+        while (runEnd + 1 <= right && iterations[row][runEnd + 1] == NOT_COMPUTED) runEnd++;
+
+        int width = runEnd - c + 1;
+        mandelbrotRowIterations(view.minX, view.incX, y, c, width, view.maxIter, &runIterations[0]);
+        for (int i = 0; i < width; i++) {
+            iterations[row][c + i] = runIterations[i];
+        }
+        c = runEnd + 1;
+    }
+}
+
+/// Colors rows [top, bottom] of pixels from their iteration counts: with the palette
+/// when color is zero, otherwise color for points in the M set and white elsewhere.
+void colorPixels(Grid<int>& pixels, const Grid<int>& iterations, int top, int bottom,
+                 int maxIter, int color, const Vector<int>& palette) {
+    for (int r = top; r <= bottom; r++) {
+        for (int c = 0; c < pixels.numCols(); c++) {
+            int numIterations = iterations[r][c];
+            if (color != 0) { // if color is non-zero, set as int color.
+                pixels[r][c] = (numIterations == maxIter) ? color : 0xffffff;
             } else {          // else color is zero, use the palette of colors for all pixels
                 pixels[r][c] = palette[numIterations % palette.size()];
             }
+        }
+    }
+}
 
-        } // end inner for-loop
-    } // end outer for-loop
+/**
+ ******************************** Deep Zoom Mandelbrot Set *******************************
+ * Draws a Mandelbrot Set centered on a point given as decimal strings, at pixel sizes far
+ * below what plain doubles can tell apart (down to about 1e-130).
+ *
+ * Only one orbit, at the center, is iterated in high precision (BigFixed). Every pixel
+ * iterates its difference from that reference orbit in doubles (perturbation):
+ *     delta' = 2 * Zref * delta + delta^2 + dc
+ * starting from a series approximation that skips the early iterations, and rebasing onto
+ * the start of the reference orbit whenever |Z| gets smaller than |delta|.
+ *
+ * @param gw - The window in which to draw the Mandelbrot set.
+ * @param centerX - real part of the center, e.g. "-0.743643887037158704752191506114774"
+ * @param centerY - imaginary part of the center
+ * @param pixelSize - width of one pixel in the complex plane
+ * @param maxIter - The maximum number of iterations
+ * @param color - The color of the fractal; zero if palette is to be used
+ * **************************************************************************************
+ */
+void mandelbrotDeepZoom(GWindow& gw, const string& centerX, const string& centerY,
+                        double pixelSize, int maxIter, int color) {
+    Vector<int> palette = setPalette();            // setup the palette
+    int width = gw.getCanvasWidth();
+    int height = gw.getCanvasHeight();
+    GBufferedImage image(width, height, 0xffffff);
+    gw.add(&image);
+    Grid<int> pixels = image.toGrid();
+    Grid<int> iterations(height, width, NOT_COMPUTED);
 
-    image.fromGrid(pixels); // Converts and puts the grid back into the image onscreen
+    mandelbrotDeepZoomRows(centerX, centerY, pixelSize, maxIter, width, height,
+                           [&](int row, const vector<int>& rowIterations) {
+        for (int c = 0; c < width; c++) {
+            iterations[row][c] = rowIterations[c];
+        }
+        if (row % REFINE_BAND == REFINE_BAND - 1 || row == height - 1) {
+            colorPixels(pixels, iterations, row - row % REFINE_BAND, row, maxIter, color, palette);
+            image.fromGrid(pixels); // show each finished band
+        }
+    });
 }
 
-int mandelbrotSetIterations(Complex Z, Complex C, int maxIterations, int numIterations) {
+/// Iteration counts of a width x height deep zoom, handed to emitRow one row at a time
+/// from the top; pixel (height / 2, width / 2) is the center.
+void mandelbrotDeepZoomRows(const string& centerX, const string& centerY, double pixelSize, int maxIter,
+                            int width, int height, const function<void(int, const vector<int>&)>& emitRow) {
+    // high-precision reference orbit at the center pixel
+    Vector<double> refR, refI;
+    mandelbrotReferenceOrbit(BigFixed(centerX), BigFixed(centerY), maxIter, refR, refI);
 
-    // if exhaust max iteration    =>  in M set
-    // if absolute value of Z > 4  =>  Not in M set
-    if (Z.abs() > 4 || numIterations == maxIterations) {
-        return numIterations;
-    } else {
-        return mandelbrotSetIterations(Z * Z + C, C, maxIterations, numIterations + 1);
+    // series approximation good for the farthest pixel (a corner)
+    double maxDelta = sqrt(width * width + height * height) / 2 * pixelSize;
+    SeriesTerms series = mandelbrotSeries(refR, refI, maxDelta, maxIter);
+
+    vector<int> rowIterations(width);
+    for (int r = 0; r < height; r++) {
+        double dci = (r - height / 2) * pixelSize;
+        for (int c = 0; c < width; c++) {
+            double dcr = (c - width / 2) * pixelSize;
+            rowIterations[c] = perturbedIterations(refR, refI, series, dcr, dci, maxIter);
+        }
+        emitRow(r, rowIterations);
+    }
+}
+
+/// Iterates Z = Z * Z + C in BigFixed and stores the orbit rounded to doubles,
+/// Z[0] = 0 up to the first escaped Z or Z[maxIter].
+void mandelbrotReferenceOrbit(const BigFixed& cr, const BigFixed& ci, int maxIter,
+                              Vector<double>& refR, Vector<double>& refI) {
+    BigFixed zr, zi;
+    for (int n = 0; n <= maxIter; n++) {
+        double r = zr.toDouble();
+        double i = zi.toDouble();
+        refR.add(r);
+        refI.add(i);
+        if (r * r + i * i > ESCAPE_RADIUS_SQUARED) break; // reference escaped
+
+        BigFixed zri = zr * zi;
+        zr = zr * zr - zi * zi + cr;
+        zi = zri + zri + ci;
+    }
+}
+
+/// Iterates the series coefficients along the reference orbit,
+///     A' = 2 Z A + 1,   B' = 2 Z B + A^2,   C' = 2 Z C + 2 A B,
+/// for as long as the cubic term stays negligible next to the quadratic one at maxDelta.
+SeriesTerms mandelbrotSeries(const Vector<double>& refR, const Vector<double>& refI,
+                             double maxDelta, int maxIter) {
+    SeriesTerms terms = {0, 0, 0, 0, 0, 0, 0};
+    int last = min(refR.size() - 1, maxIter);
+
+    for (int n = 0; n < last; n++) {
+        double zr2 = 2 * refR[n];
+        double zi2 = 2 * refI[n];
+        SeriesTerms next = terms;
+        next.ar = zr2 * terms.ar - zi2 * terms.ai + 1;
+        next.ai = zr2 * terms.ai + zi2 * terms.ar;
+        next.br = zr2 * terms.br - zi2 * terms.bi + (terms.ar * terms.ar - terms.ai * terms.ai);
+        next.bi = zr2 * terms.bi + zi2 * terms.br + 2 * terms.ar * terms.ai;
+        next.cr = zr2 * terms.cr - zi2 * terms.ci + 2 * (terms.ar * terms.br - terms.ai * terms.bi);
+        next.ci = zr2 * terms.ci + zi2 * terms.cr + 2 * (terms.ar * terms.bi + terms.ai * terms.br);
+        next.skip = n + 1;
+
+        // stop before the dropped terms could matter
+        double bAbs = sqrt(next.br * next.br + next.bi * next.bi);
+        double cAbs = sqrt(next.cr * next.cr + next.ci * next.ci);
+        if (!(cAbs * maxDelta <= SERIES_TOLERANCE * bAbs) || !isfinite(cAbs)) break;
+
+        terms = next;
+    }
+    return terms;
+}
+
+/// Iteration count of the pixel at offset dc from the reference point, by perturbation.
+int perturbedIterations(const Vector<double>& refR, const Vector<double>& refI, const SeriesTerms& series,
+                        double dcr, double dci, int maxIter) {
+    // delta after the skipped iterations: A dc + B dc^2 + C dc^3
+    double dc2r = dcr * dcr - dci * dci, dc2i = 2 * dcr * dci;
+    double dc3r = dc2r * dcr - dc2i * dci, dc3i = dc2r * dci + dc2i * dcr;
+    double dr = series.ar * dcr - series.ai * dci + series.br * dc2r - series.bi * dc2i
+              + series.cr * dc3r - series.ci * dc3i;
+    double di = series.ar * dci + series.ai * dcr + series.br * dc2i + series.bi * dc2r
+              + series.cr * dc3i + series.ci * dc3r;
+
+    int refLast = refR.size() - 1;
+    int m = series.skip;   // index into the reference orbit
+    int n = series.skip;   // iterations done so far
+
+    while (n < maxIter) {
+        double zr = refR[m] + dr;
+        double zi = refI[m] + di;
+        double zAbs2 = zr * zr + zi * zi;
+        if (zAbs2 > ESCAPE_RADIUS_SQUARED) break; // |Z| > 4  =>  Not in M set
+
+        // rebase onto Zref[0] = 0 when the reference stops being a good approximation
+        if (zAbs2 < dr * dr + di * di || m == refLast) {
+            dr = zr;
+            di = zi;
+            m = 0;
+        }
+
+        // delta' = (2 Zref + delta) * delta + dc
+        double tr = 2 * refR[m] + dr;
+        double ti = 2 * refI[m] + di;
+        double nextR = tr * dr - ti * di + dcr;
+        di = tr * di + ti * dr + dci;
+        dr = nextR;
+        m++;
+        n++;
     }
+    return n;
+}
+
+int mandelbrotSetIterations(Complex Z, Complex C, int maxIterations, int numIterations) {
+    return mandelbrotIterations(Z.realPart(), Z.imagPart(), C.realPart(), C.imagPart(),
+                                maxIterations, numIterations);
 }
 
 int mandelbrotSetIterations(Complex cpx, int maxIterations) {
@@ -157,6 +651,137 @@ int mandelbrotSetIterations(Complex cpx, int maxIterations) {
     return mandelbrotSetIterations(Complex (0, 0), cpx, maxIterations, 0);
 }
 
+/// Iterative escape-time kernel: Z = Z * Z + C until |Z| > 4 or maxIterations is reached.
+/// Same arithmetic as the Complex operators, so the counts match the recursive version.
+/// The orbit is also checked for exact cycles (Brent's method: compare against a saved Z,
+/// re-saved at doubling intervals); a repeated Z can never escape, so it ends at maxIterations.
+/// @param zr, zi - starting Z
+/// @param cr, ci - the point C being tested
+/// @param maxIterations - the maximum number of iterations
+/// @param numIterations - iterations already done on Z
+/// @return number of iterations done before Z escaped (maxIterations if it never did)
+int mandelbrotIterations(double zr, double zi, double cr, double ci, int maxIterations, int numIterations) {
+    double savedR = zr, savedI = zi; // orbit point to compare against for a cycle
+    int period = 8;                  // cycle length covered by the current saved point
+    int checkpoint = numIterations + period;
+
+    while (numIterations < maxIterations) {
+        double zr2 = zr * zr;
+        double zi2 = zi * zi;
+        if (zr2 + zi2 > ESCAPE_RADIUS_SQUARED) break; // |Z| > 4  =>  Not in M set
+
+        double zri = zr * zi;
+        zi = (zri + zri) + ci;
+        zr = (zr2 - zi2) + cr;
+        numIterations++;
+
+        if (zr == savedR && zi == savedI) return maxIterations; // periodic orbit => in M set
+        if (numIterations == checkpoint) {
+            savedR = zr;
+            savedI = zi;
+            period *= 2;
+            checkpoint = numIterations + period;
+        }
+    }
+    return numIterations;
+}
+
+/// Closed-form interior test, so most points of the set skip the iteration entirely.
+/// @return true if C lies in the main cardioid or in the period-2 bulb around -1
+bool inMainCardioidOrBulb(double cr, double ci) {
+    double ci2 = ci * ci;
+
+    // period-2 bulb: |C + 1| <= 1/4
+    if ((cr + 1) * (cr + 1) + ci2 <= 0.0625) return true;
+
+    // main cardioid: q * (q + (x - 1/4)) <= y^2 / 4, where q = (x - 1/4)^2 + y^2
+    double xq = cr - 0.25;
+    double q = xq * xq + ci2;
+    return q * (q + xq) <= 0.25 * ci2;
+}
+
+/// Computes the iteration counts of a run of pixels in one row,
+/// C = (minX + c*incX, y) for c in [startCol, startCol + width).
+/// With AVX2, eight pixels run together as two interleaved groups of four double lanes
+/// (two independent dependency chains); a lane stops counting once it escapes. Lanes in the
+/// cardioid or bulb start out finished, and lanes whose orbit repeats exactly are finished
+/// at maxIterations, just like the scalar kernel.
+/// @param iterations - output array of size width, iterations[i] is column startCol + i
+void mandelbrotRowIterations(double minX, double incX, double y, int startCol, int width,
+                             int maxIterations, int* iterations) {
+    int c = 0;
+
+#ifdef __AVX2__
+    const __m256d escape = _mm256_set1_pd(ESCAPE_RADIUS_SQUARED);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d ci = _mm256_set1_pd(y);
+    const __m256d maxCount = _mm256_set1_pd(maxIterations);
+
+    for (; c + 8 <= width; c += 8) {
+        double cr[8];
+        double interior[8]; // starting count: maxIterations for lanes already known to be in the set
+        for (int i = 0; i < 8; i++) {
+            cr[i] = minX + (startCol+c+i)*incX;
+            interior[i] = inMainCardioidOrBulb(cr[i], y) ? maxIterations : 0;
+        }
+        __m256d crA = _mm256_loadu_pd(cr), crB = _mm256_loadu_pd(cr + 4);
+        __m256d countsA = _mm256_loadu_pd(interior), countsB = _mm256_loadu_pd(interior + 4);
+        __m256d activeA = _mm256_cmp_pd(countsA, _mm256_setzero_pd(), _CMP_EQ_OQ);
+        __m256d activeB = _mm256_cmp_pd(countsB, _mm256_setzero_pd(), _CMP_EQ_OQ);
+        __m256d zrA = _mm256_setzero_pd(), ziA = _mm256_setzero_pd();
+        __m256d zrB = _mm256_setzero_pd(), ziB = _mm256_setzero_pd();
+        __m256d savedRA = zrA, savedIA = ziA, savedRB = zrB, savedIB = ziB;
+        int period = 8, checkpoint = period;
+
+        for (int n = 0; n < maxIterations; n++) {
+            __m256d zr2A = _mm256_mul_pd(zrA, zrA), zi2A = _mm256_mul_pd(ziA, ziA);
+            __m256d zr2B = _mm256_mul_pd(zrB, zrB), zi2B = _mm256_mul_pd(ziB, ziB);
+
+            // a lane stays active while NOT(|Z|^2 > threshold), the negation of the scalar test
+            activeA = _mm256_and_pd(activeA, _mm256_cmp_pd(_mm256_add_pd(zr2A, zi2A), escape, _CMP_NGT_UQ));
+            activeB = _mm256_and_pd(activeB, _mm256_cmp_pd(_mm256_add_pd(zr2B, zi2B), escape, _CMP_NGT_UQ));
+            if (_mm256_movemask_pd(_mm256_or_pd(activeA, activeB)) == 0) break; // all eight escaped
+
+            countsA = _mm256_add_pd(countsA, _mm256_and_pd(activeA, one));
+            countsB = _mm256_add_pd(countsB, _mm256_and_pd(activeB, one));
+
+            __m256d zriA = _mm256_mul_pd(zrA, ziA), zriB = _mm256_mul_pd(zrB, ziB);
+            ziA = _mm256_add_pd(_mm256_add_pd(zriA, zriA), ci);
+            ziB = _mm256_add_pd(_mm256_add_pd(zriB, zriB), ci);
+            zrA = _mm256_add_pd(_mm256_sub_pd(zr2A, zi2A), crA);
+            zrB = _mm256_add_pd(_mm256_sub_pd(zr2B, zi2B), crB);
+
+            // periodic lanes are in the set: jump their count to maxIterations and retire them
+            __m256d cycleA = _mm256_and_pd(activeA, _mm256_and_pd(_mm256_cmp_pd(zrA, savedRA, _CMP_EQ_OQ),
+                                                                   _mm256_cmp_pd(ziA, savedIA, _CMP_EQ_OQ)));
+            __m256d cycleB = _mm256_and_pd(activeB, _mm256_and_pd(_mm256_cmp_pd(zrB, savedRB, _CMP_EQ_OQ),
+                                                                   _mm256_cmp_pd(ziB, savedIB, _CMP_EQ_OQ)));
+            countsA = _mm256_blendv_pd(countsA, maxCount, cycleA);
+            countsB = _mm256_blendv_pd(countsB, maxCount, cycleB);
+            activeA = _mm256_andnot_pd(cycleA, activeA);
+            activeB = _mm256_andnot_pd(cycleB, activeB);
+
+            if (n + 1 == checkpoint) {
+                savedRA = zrA; savedIA = ziA;
+                savedRB = zrB; savedIB = ziB;
+                period *= 2;
+                checkpoint = n + 1 + period;
+            }
+        }
+
+        _mm_storeu_si128((__m128i*) (iterations + c),     _mm256_cvtpd_epi32(countsA));
+        _mm_storeu_si128((__m128i*) (iterations + c + 4), _mm256_cvtpd_epi32(countsB));
+    }
+#endif
+
+    // scalar kernel for the remaining pixels (or all of them without AVX2)
+    for (; c < width; c++) {
+        double cr = minX + (startCol+c)*incX;
+        iterations[c] = inMainCardioidOrBulb(cr, y) ? maxIterations
+                                                    : mandelbrotIterations(0, 0, cr, y, maxIterations, 0);
+    }
+}
+
 // Helper function to set the palette
 Vector<int> setPalette() {
     Vector<int> colors;
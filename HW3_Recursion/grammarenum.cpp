@@ -0,0 +1,232 @@
+//
+//  grammarenum.cpp
+//
+//  Created by Jian Zhong on 9/12/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#include "grammarenum.h"
+#include <climits>
+#include "error.h"
+#include "strlib.h"
+
+// Function Prototypes:
+uint64_t addCounts(uint64_t a, uint64_t b);
+uint64_t multiplyCounts(uint64_t a, uint64_t b);
+
+/// Function to add two derivation counts.
+/// @return a + b, or an error if it does not fit in 64 bits
+uint64_t addCounts(uint64_t a, uint64_t b) {
+    if (a > UINT64_MAX - b) error("GrammarEnumerator: derivation count exceeds 64 bits.");
+    return a + b;
+}
+
+/// Function to multiply two derivation counts.
+/// @return a * b, or an error if it does not fit in 64 bits
+uint64_t multiplyCounts(uint64_t a, uint64_t b) {
+    if (a != 0 && b > UINT64_MAX / a) error("GrammarEnumerator: derivation count exceeds 64 bits.");
+    return a * b;
+}
+
+GrammarEnumerator::GrammarEnumerator(const CompiledGrammar& grammar, int maxLength)
+    : grammar(grammar), maxLength(maxLength) {
+    if (maxLength < 0) error("GrammarEnumerator: maxLength must not be negative.");
+
+    computeMinLengths();
+
+    int lengths = maxLength + 1;
+    symbolCounts.assign(grammar.numNonTerminals * lengths, 0);
+    symbolState.assign(grammar.numNonTerminals * lengths, UNKNOWN);
+    suffixCounts.assign(grammar.tokens.size() * lengths, 0);
+    suffixDone.assign(grammar.tokens.size() * lengths, false);
+}
+
+/// Function to find the fewest terminals each symbol and rule suffix derives, by
+/// relaxing every rule until nothing changes. The counts use them to skip splits
+/// that cannot produce a sentence, so a recursive rule never asks for the count it
+/// is computing unless the grammar really has a cycle.
+void GrammarEnumerator::computeMinLengths() {
+    minLength.assign(grammar.symbolText.size(), INT_MAX);
+    for (int s = grammar.numNonTerminals; s < grammar.symbolText.size(); s++) {
+        minLength[s] = 1; // a terminal
+    }
+    minSuffixLength.assign(grammar.tokens.size(), INT_MAX);
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int symbol = 0; symbol < grammar.numNonTerminals; symbol++) {
+            for (int p = grammar.firstProduction[symbol]; p < grammar.firstProduction[symbol + 1]; p++) {
+                // sum the rule from its end, remembering each suffix on the way
+                long total = 0;
+                for (int t = grammar.firstToken[p + 1] - 1; t >= grammar.firstToken[p]; t--) {
+                    int first = minLength[grammar.tokens[t]];
+                    total = (first == INT_MAX || total == INT_MAX) ? INT_MAX : min((long) INT_MAX, total + first);
+                    minSuffixLength[t] = (int) total;
+                }
+                if (total < minLength[symbol]) {
+                    minLength[symbol] = (int) total;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+/// Function to count the derivations of a symbol, memoized per (symbol, length).
+/// @param symbol - Id of the symbol
+/// @param length - Number of terminals
+/// @return Number of derivations
+uint64_t GrammarEnumerator::count(int symbol, int length) {
+    checkLength(length);
+    if (!grammar.isNonTerminal(symbol)) return length == 1 ? 1 : 0;
+    if (length < minLength[symbol]) return 0;
+
+    int key = symbol * (maxLength + 1) + length;
+    if (symbolState[key] == DONE) return symbolCounts[key];
+    if (symbolState[key] == IN_PROGRESS) {
+        error("GrammarEnumerator: " + grammar.symbolText[symbol] + " derives itself without consuming "
+              "terminals, so it has infinitely many derivations.");
+    }
+
+    symbolState[key] = IN_PROGRESS;
+    uint64_t total = 0;
+    for (int p = grammar.firstProduction[symbol]; p < grammar.firstProduction[symbol + 1]; p++) {
+        total = addCounts(total, suffixCount(grammar.firstToken[p], grammar.firstToken[p + 1], length));
+    }
+    symbolCounts[key] = total;
+    symbolState[key] = DONE;
+    return total;
+}
+
+/// Function to count the derivations of the rule symbols tokens[token .. end) with
+/// exactly length terminals, splitting the length between the first symbol and the rest.
+/// @return Number of derivations
+uint64_t GrammarEnumerator::suffixCount(int token, int end, int length) {
+    if (token == end) return length == 0 ? 1 : 0;
+    if (token + 1 == end) return count(grammar.tokens[token], length);
+    if (length < minSuffixLength[token]) return 0;
+
+    int key = token * (maxLength + 1) + length;
+    if (suffixDone[key]) return suffixCounts[key];
+
+    int first = grammar.tokens[token];
+    uint64_t total = 0;
+    for (int m = minLength[first]; m <= length - minSuffixLength[token + 1]; m++) {
+        uint64_t rest = suffixCount(token + 1, end, length - m);
+        if (rest == 0) continue;
+        total = addCounts(total, multiplyCounts(count(first, m), rest));
+    }
+    suffixCounts[key] = total;
+    suffixDone[key] = true;
+    return total;
+}
+
+string GrammarEnumerator::unrank(int symbol, int length, uint64_t rank) {
+    if (rank >= count(symbol, length)) {
+        error("GrammarEnumerator: rank is out of range.");
+    }
+    string sentence;
+    unrankSymbol(symbol, length, rank, sentence);
+    return sentence;
+}
+
+string GrammarEnumerator::sample(int symbol, int length, GrammarRng& rng) {
+    uint64_t total = count(symbol, length);
+    if (total == 0) {
+        error("GrammarEnumerator: " + grammar.symbolText[symbol] + " has no derivation of length "
+              + integerToString(length) + ".");
+    }
+
+    // reject the lowest (2^64 mod total) values so every rank is equally likely
+    uint64_t biased = (0 - total) % total;
+    uint64_t r;
+    do {
+        r = rng.next();
+    } while (r < biased);
+    return unrank(symbol, length, r % total);
+}
+
+void GrammarEnumerator::enumerate(int symbol, const function<void(const string&)>& visit) {
+    string sentence;
+    for (int length = 0; length <= maxLength; length++) {
+        uint64_t total = count(symbol, length);
+        for (uint64_t rank = 0; rank < total; rank++) {
+            sentence.clear();
+            unrankSymbol(symbol, length, rank, sentence);
+            visit(sentence);
+        }
+    }
+}
+
+void GrammarEnumerator::checkLength(int length) const {
+    if (length < 0 || length > maxLength) {
+        error("GrammarEnumerator: length " + integerToString(length) + " is outside 0.."
+              + integerToString(maxLength) + ".");
+    }
+}
+
+/// Function to append the derivation of a symbol with a given rank. Ranks are ordered
+/// by rule first, then as in unrankSuffix.
+void GrammarEnumerator::unrankSymbol(int symbol, int length, uint64_t rank, string& out) {
+    if (!grammar.isNonTerminal(symbol)) {
+        out += grammar.symbolText[symbol];
+        out += ' ';
+        return;
+    }
+
+    for (int p = grammar.firstProduction[symbol]; p < grammar.firstProduction[symbol + 1]; p++) {
+        int first = grammar.firstToken[p], end = grammar.firstToken[p + 1];
+        uint64_t block = suffixCount(first, end, length);
+        if (rank < block) {
+            unrankSuffix(first, end, length, rank, out);
+            return;
+        }
+        rank -= block;
+    }
+}
+
+/// Function to append the derivation of tokens[token .. end) with a given rank. Ranks
+/// are ordered by the length of the first symbol, then its rank, then the rest's rank.
+void GrammarEnumerator::unrankSuffix(int token, int end, int length, uint64_t rank, string& out) {
+    if (token == end) return;
+    if (token + 1 == end) {
+        unrankSymbol(grammar.tokens[token], length, rank, out);
+        return;
+    }
+
+    int first = grammar.tokens[token];
+    for (int m = minLength[first]; m <= length - minSuffixLength[token + 1]; m++) {
+        uint64_t rest = suffixCount(token + 1, end, length - m);
+        if (rest == 0) continue;
+        uint64_t block = multiplyCounts(count(first, m), rest);
+        if (rank < block) {
+            unrankSymbol(first, m, rank / rest, out);
+            unrankSuffix(token + 1, end, length - m, rank % rest, out);
+            return;
+        }
+        rank -= block;
+    }
+}
+
+/// Function to list every sentence of a symbol up to a length.
+/// @param input - Input stream of BNF file.
+/// @param symbol - Symbol to enumerate
+/// @param maxLength - Most terminals in a sentence
+/// @return Vector of all derivations of symbol, shortest first
+Vector<string> grammarEnumerate(istream& input, const string& symbol, int maxLength) {
+    Vector<string> allResults;
+    CompiledGrammar BNF = scanFileIntoMap(input);
+    int start = BNF.idOf(symbol);
+
+    if (start < 0) {
+        if (maxLength >= 1) allResults.add(symbol + " "); // not in the grammar: a terminal symbol
+        return allResults;
+    }
+
+    GrammarEnumerator enumerator(BNF, maxLength);
+    enumerator.enumerate(start, [&](const string& sentence) {
+        allResults.add(sentence);
+    });
+    return allResults;
+}
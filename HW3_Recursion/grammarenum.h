@@ -0,0 +1,88 @@
+//
+//  grammarenum.h
+//
+//  Exhaustive generation from a compiled grammar. The number of derivations of
+//  every symbol and sentence length is counted once by dynamic programming, so
+//  the Nth sentence of a length can be built directly (unranking), every
+//  sentence can be listed in order, and sentences can be sampled uniformly.
+//
+//  Created by Jian Zhong on 9/12/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#ifndef _grammarenum_h
+#define _grammarenum_h
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "compiledgrammar.h"
+#include "vector.h"
+
+using namespace std;
+
+/*
+ * Counts and builds the derivations of a compiled grammar with at most maxLength
+ * terminals. The length of a sentence is its number of terminal symbols. Derivations
+ * are counted, not distinct strings: an ambiguous grammar lists a sentence once per
+ * derivation. Counts that do not fit in 64 bits, and rule cycles that derive a symbol
+ * from itself without consuming terminals (infinitely many derivations), are errors.
+ */
+class GrammarEnumerator {
+public:
+    /*
+     * Construct an enumerator for a grammar, which must outlive it.
+     */
+    GrammarEnumerator(const CompiledGrammar& grammar, int maxLength);
+
+    /*
+     * Return the number of derivations of symbol with exactly length terminals.
+     */
+    uint64_t count(int symbol, int length);
+
+    /*
+     * Return the derivation of symbol with the given length and rank, where
+     * 0 <= rank < count(symbol, length). Terminals are followed by a space.
+     */
+    string unrank(int symbol, int length, uint64_t rank);
+
+    /*
+     * Return a derivation of symbol with the given length, chosen uniformly at random.
+     */
+    string sample(int symbol, int length, GrammarRng& rng);
+
+    /*
+     * Call visit with every derivation of symbol, shortest first and in rank order
+     * within a length. The string passed to visit is reused between calls.
+     */
+    void enumerate(int symbol, const function<void(const string& sentence)>& visit);
+
+private:
+    /* Memo state of a count */
+    enum CountState : unsigned char { UNKNOWN, IN_PROGRESS, DONE };
+
+    const CompiledGrammar& grammar;
+    int maxLength;
+    vector<int> minLength;          // symbol id -> fewest terminals it derives (INT_MAX if none)
+    vector<int> minSuffixLength;    // token index -> fewest terminals from there to the end of its rule
+    vector<uint64_t> symbolCounts;  // [non-terminal][length] derivation counts
+    vector<CountState> symbolState;
+    vector<uint64_t> suffixCounts;  // [token index][length] counts of the rest of a rule
+    vector<bool> suffixDone;
+
+    void computeMinLengths();
+    uint64_t suffixCount(int token, int end, int length);
+    void checkLength(int length) const;
+    void unrankSymbol(int symbol, int length, uint64_t rank, string& out);
+    void unrankSuffix(int token, int end, int length, uint64_t rank, string& out);
+};
+
+/*
+ * Reads a BNF file and returns every sentence that symbol derives with at most
+ * maxLength terminals, in the order of GrammarEnumerator::enumerate.
+ */
+Vector<string> grammarEnumerate(istream& input, const string& symbol, int maxLength);
+
+#endif // _grammarenum_h
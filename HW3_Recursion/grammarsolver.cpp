@@ -5,15 +5,23 @@
  */
 
 #include "grammarsolver.h"
+#include "compiledgrammar.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "hashmap.h"
+#include "error.h"
 #include "random.h"
+#include "strlib.h"
 
 using namespace std;
 
 // Function Prototypes:
 Vector<string> grammarGenerate(istream&, const string&, int);
-HashMap<string, Vector<string>> scanFileIntoMap(istream&);
-void grammarHelper(const HashMap<string, Vector<string>>&, string, string&);
+CompiledGrammar scanFileIntoMap(istream&);
 
 /**
  * Generates grammar for a given symbol a certain number of times given
@@ -28,24 +36,92 @@ void grammarHelper(const HashMap<string, Vector<string>>&, string, string&);
  */
 Vector<string> grammarGenerate(istream& input, string symbol, int times) {
     Vector<string> allResults;
-    HashMap<string, Vector<string>> BNF = scanFileIntoMap(input);
+    CompiledGrammar BNF = scanFileIntoMap(input);
+    GrammarExpander expander(BNF);
+    int start = BNF.idOf(symbol);
 
     for (int i = 0; i < times; i++) {
-        string result;
-        grammarHelper(BNF, symbol, result);
-        allResults.add(result);
+        if (start < 0) {
+            allResults.add(symbol + " "); // not in the grammar: a terminal symbol
+        } else {
+            allResults.add(expander.expand(start));
+        }
+    }
+
+    return allResults;
+}
+
+// Number of results a worker claims at a time.
+const int GENERATE_CHUNK = 256;
+
+/// Function to generate grammar on several threads. Workers claim chunks of result
+/// indices from a shared counter and write their results in place.
+/// @param input - Input stream of BNF file.
+/// @param symbol - Symbol to generate
+/// @param times - Number of times grammar is generated
+/// @param seed - Seed of the random streams
+/// @param numThreads - Number of worker threads, 0 for one per core
+/// @return Vector of strings of size times with random generations of symbol
+Vector<string> grammarGenerateParallel(istream& input, const string& symbol, int times,
+                                       uint64_t seed, int numThreads) {
+    CompiledGrammar BNF = scanFileIntoMap(input);
+    int start = BNF.idOf(symbol);
+    Vector<string> allResults(max(times, 0));
+
+    if (start < 0) {
+        for (int i = 0; i < times; i++) {
+            allResults[i] = symbol + " "; // not in the grammar: a terminal symbol
+        }
+        return allResults;
+    }
+
+    if (numThreads <= 0) numThreads = max(1, (int) thread::hardware_concurrency());
+    numThreads = min(numThreads, (times + GENERATE_CHUNK - 1) / GENERATE_CHUNK);
+
+    atomic<int> nextChunk(0);
+    mutex failureLock;
+    exception_ptr failure; // the first error thrown by any worker
+    auto worker = [&]() {
+        try {
+            GrammarExpander expander(BNF);
+            for (;;) {
+                int first = nextChunk.fetch_add(GENERATE_CHUNK);
+                if (first >= times) break;
+                for (int i = first; i < min(first + GENERATE_CHUNK, times); i++) {
+                    // scramble (seed, i) into the stream's start state
+                    GrammarRng rng(GrammarRng(seed ^ ((uint64_t) i * 0xd1b54a32d192ed03ULL)).next());
+                    allResults[i] = expander.expand(start, &rng);
+                }
+            }
+        } catch (...) {
+            // keep the error for the caller, and stop the other workers
+            lock_guard<mutex> lock(failureLock);
+            if (!failure) failure = current_exception();
+            nextChunk = times;
+        }
+    };
+
+    std::vector<thread> workers;
+    for (int t = 1; t < numThreads; t++) {
+        workers.emplace_back(worker);
+    }
+    worker(); // the calling thread takes a share too
+    for (thread& t : workers) {
+        t.join();
     }
 
+    if (failure) rethrow_exception(failure);
     return allResults;
 }
 
-/// Function to read the Input File and return a map of BNF content.
+/// Function to read the Input File and compile the BNF content.
 /// @param input - File input stream
-/// @return a map of BNF content.
-HashMap<string, Vector<string> > scanFileIntoMap(istream& input) {
+/// @return the BNF content with symbols as ids and rules pre-split into symbols.
+CompiledGrammar scanFileIntoMap(istream& input) {
     // scan the file line by line and stores contents into the BNFmap.
     string line;
-    HashMap<string, Vector<string> > BNF;
+    HashMap<string, Vector<string> > BNFmap;
+    Vector<string> nonTerminals; // in order of first definition
 
     // while read a line in file,
     while(getline(input, line)) {
@@ -53,41 +129,84 @@ HashMap<string, Vector<string> > scanFileIntoMap(istream& input) {
         Vector<string> splitedLine = stringSplit(line, "::=");
 
         // add symbols(splited[0]) and rules(splited[1]) into the BNFmap
-        BNF.put(splitedLine[0], stringSplit(splitedLine[1], "|"));
+        if (!BNFmap.containsKey(splitedLine[0])) nonTerminals.add(splitedLine[0]);
+        BNFmap.put(splitedLine[0], stringSplit(splitedLine[1], "|"));
+    }
+
+    // number the non-terminals first, so every rule can refer to them by id
+    CompiledGrammar BNF;
+    BNF.numNonTerminals = nonTerminals.size();
+    for (string symbol : nonTerminals) {
+        BNF.symbolIds.put(symbol, BNF.symbolText.size());
+        BNF.symbolText.add(symbol);
+    }
+
+    // split every rule into symbols once; symbols seen for the first time are terminals
+    for (string symbol : nonTerminals) {
+        BNF.firstProduction.add(BNF.firstToken.size());
+        for (string rule : BNFmap[symbol]) {
+            BNF.firstToken.add(BNF.tokens.size());
+            for (string subSymbol : stringSplit(rule, " ")) {
+                if (!BNF.symbolIds.containsKey(subSymbol)) {
+                    BNF.symbolIds.put(subSymbol, BNF.symbolText.size());
+                    BNF.symbolText.add(subSymbol);
+                }
+                BNF.tokens.add(BNF.symbolIds[subSymbol]);
+            }
+        }
     }
+    BNF.firstProduction.add(BNF.firstToken.size());
+    BNF.firstToken.add(BNF.tokens.size());
+
     return BNF;
 }
 
-/// Function to generate Random Expansions from the Grammar:
-/// @param BNF - A map of BNF content
-/// @param symbol - Symbol to generate
-/// @param result - Grammer result
-void grammarHelper(const HashMap<string, Vector<string>>& BNF, string symbol, string& result) {
-
-    // if symbol is non-terminal symbol, randomly choose a sub-symbol and explorer it.
-    if (BNF.containsKey(symbol)) {
+GrammarExpander::GrammarExpander(const CompiledGrammar& grammar, const ExpansionLimits& limits)
+    : grammar(grammar), limits(limits) {
+}
 
-        // find a random next symbol
-        string symbolStr = randomElement(BNF[symbol]);
+/// Function to generate Random Expansions from the Grammar, depth-first and left to
+/// right like a recursive expansion, so rules are chosen in the same order.
+/// @param symbol - Id of the symbol to generate
+/// @param rng - Random stream for choosing rules, or null to use random.h
+/// @return Grammer result
+const string& GrammarExpander::expand(int symbol, GrammarRng* rng) {
+    output.clear();   // keeps its capacity
+    stack.clear();
+    stack.push_back({symbol, 0});
+
+    while (!stack.empty()) {
+        PendingSymbol current = stack.back();
+        stack.pop_back();
+
+        // if symbol is non-terminal symbol, randomly choose a rule and push its sub-symbols.
+        if (grammar.isNonTerminal(current.symbol)) {
+            if (current.depth >= limits.maxDepth) {
+                error("Grammar expansion is nested deeper than " + integerToString(limits.maxDepth) + ".");
+            }
 
-        // if the symbol contains spaces, multiple symbols exist.
-        if (stringContains(symbolStr, " ")) {
+            int first = grammar.firstProduction[current.symbol];
+            int count = grammar.firstProduction[current.symbol + 1] - first;
+            int rule = first + (rng != nullptr ? rng->nextInt(count) : randomInteger(0, count - 1));
 
-            // split multiple symbols into a vector by whitespace.
-            Vector<string> subSymbols = stringSplit(symbolStr, " ");
+            // an empty rule is written as a lone space, like the empty symbol it once was
+            if (grammar.firstToken[rule + 1] == grammar.firstToken[rule]) {
+                output += ' ';
+            }
 
-            // explorer each sub-symbol in subSymbols recursively.
-            for (string subSymbol : subSymbols) {
-                grammarHelper(BNF, subSymbol, result);
+            // push in reverse so the leftmost sub-symbol is expanded first
+            for (int i = grammar.firstToken[rule + 1] - 1; i >= grammar.firstToken[rule]; i--) {
+                stack.push_back({grammar.tokens[i], current.depth + 1});
             }
 
         } else {
-            // else, explorer the just 1 symbol recursively.
-            grammarHelper(BNF, symbolStr, result);
+            // found a terminal symbol! add it into output.
+            output += grammar.symbolText[current.symbol];
+            output += ' ';
+            if ((int) output.length() > limits.maxLength) {
+                error("Grammar expansion is longer than " + integerToString(limits.maxLength) + " characters.");
+            }
         }
-
-    } else {
-        // found a terminal symbol!
-        result += symbol + " "; // add it into result.
     }
+    return output;
 }
@@ -7,33 +7,33 @@
 
 #include "Boggle.h"
 
-// letters on all 6 sides of every cube
-static string CUBES[16] = {
-    "AAEEGN", "ABBJOO", "ACHOPS", "AFFKPS",
-    "AOOTTW", "CIMOTU", "DEILRX", "DELRVY",
-    "DISTTY", "EEGHNW", "EEINSU", "EHRTVW",
-    "EIOSST", "ELRTTY", "HIMNQU", "HLNNRZ"
-};
-
-Boggle::Boggle(Lexicon& dictionary, string& boardText) {
-    boggleBoard.resize(4,4); // initialize a 4x4 game board
-    boggleDict = dictionary; // setup boggle dictionary
+Boggle::Boggle(shared_ptr<const CompactLexicon> dictionary, string& boardText, int rows, int cols)
+    : boggleDict(dictionary), // setup boggle dictionary
+      solver(boggleDict, rows, cols) {
+    boggleBoard.resize(rows, cols); // initialize a rows x cols game board
+    adjacency = BoardAdjacency::forSize(rows, cols);
 
     // BoggleGUI::labelAllCubes(boardText);
 
     // generated ramdom board text
     if (boardText.empty()) {
-        shuffle(CUBES, 16); // shuffle the 16 cube loations in CUBES
+        int order[16];      // the 16 cube locations
         int pos = 0;        // shuffle the cube letter
         for (int r = 0; r < boggleBoard.nRows; r++) {
             for(int c = 0; c < boggleBoard.nCols; c++) {
-                boggleBoard[r][c] = CUBES[pos][randomInteger(0, 5)];
+                if (pos % 16 == 0) {
+                    // shuffle the 16 cube locations, again for every 16 cells
+                    for (int i = 0; i < 16; i++) order[i] = i;
+                    shuffle(order, 16);
+                }
+                boggleBoard[r][c] = CUBES[order[pos % 16]][randomInteger(0, 5)];
                 boardText += boggleBoard[r][c];
                 pos++;
             }
         }
     } else {
     // user mannual input board text
+         if ((int) boardText.length() != rows * cols) throw "The board text does not fit the board size.";
          boardText = toUpperCase(boardText); // just uppcase all letters
          int pos = 0;
          for (int r = 0; r < boggleBoard.nRows; r++) {
@@ -43,6 +43,7 @@ Boggle::Boggle(Lexicon& dictionary, string& boardText) {
              }
          }
     }
+    cells = boardText;
 
 }
 
@@ -57,158 +58,109 @@ bool Boggle::checkWord(string word) {
     
     if (word.length() >= 4 &&          // valid Boggle word
         !wordsHuman.contains(word) &&  // has not already been found
-        boggleDict.contains(word)) {   // is in boggleDict
+        boggleDict->contains(word)) {  // is in boggleDict
         return true;
     }
     return false;
 }
 
-bool Boggle::humanWordSearch(string word) {
-    BoggleGUI::setAnimationDelay(100);  // set GUI delay time
+bool Boggle::humanWordSearch(string word, AnimationT animation) {
+    Vector<int> path;              // cells of the word, found without the GUI
+    if (!findWordPath(word, path)) return false;
+    wordsHuman.add(toUpperCase(word));
+
+    // show only the path found, once the last animation has finished
+    if (animation != NoAnimation && this->animation.valid()) {
+        this->animation.wait();
+    }
+    if (animation == AnimateNow) {
+        animatePath(path);
+    } else if (animation == AnimateInBackground) {
+        this->animation = async(launch::async, [this, path]() { animatePath(path); });
+    }
+    return true;
+}
+
+bool Boggle::findWordPath(string word, Vector<int>& path) const {
     word = toUpperCase(word);      // case-insensitive
+    path.clear();
+    if (word.empty()) return false;
+
     char first = word[0];          // letter to be found
-    Grid<char> marked;             // creat a separate board for marking
-    marked.resize(4, 4);           // a separate grid to record used grid, 'X' means used.
-
-    // loop through the board grids
-    for (int r = 0; r < boggleBoard.nRows; r++) {
-        for (int c = 0; c < boggleBoard.nCols; c++) {
-
-            // hightlight each grid while searching
-            BoggleGUI::setHighlighted(r, c, true);
-            marked.set(r, c, 'X'); // mark the grid as used.
-
-            // if first letter of word found on a grid:
-            if (first == boggleBoard[r][c]) {
-                
-                // try to form word based on boggleBoard[r][c] by recursive bactrack
-                if (humanHelper(word, word.substr(0, 1), r, c, marked)) { // if can be formed!
-                    wordsHuman.add(word);
-                    return true;
-                } else {    // if can't be formed
-                    BoggleGUI::setHighlighted(r, c, false); // un-hightlight the grid
-                    marked.set(r, c, ' ');                  // un-mark the grid
-                }
-                
-            } else { // if not found on that grid
-                BoggleGUI::setHighlighted(r, c, false); // un-hightlight the grid
-                marked.set(r, c, ' ');                  // un-mark the grid
-            }
-            
-        }
+    CellSet marked;                // a separate set to record used cells
+    marked.reset(cells.size());
+
+    // loop through the board cells
+    for (int cell = 0; cell < (int) cells.size(); cell++) {
+        // if first letter of word found on a grid:
+        int node = first == cells[cell] ? boggleDict->child(CompactLexicon::ROOT, first) : -1;
+        if (node < 0) continue;
+
+        // try to form word based on this cell by recursive bactrack
+        marked.add(cell);          // mark the grid as used.
+        path.add(cell);
+        if (humanHelper(word, 1, cell, node, marked, path)) return true; // if can be formed!
+        path.remove(path.size() - 1);
+        marked.remove(cell);       // un-mark the grid
     }
     return false; // finish loopping the entire board, if no word can be formed, return false.
 }
 
-bool Boggle::humanHelper(string word, string formed, int row, int col, Grid<char>& marked) const {
-    char next = word[1];  // get the second letter of word
+bool Boggle::humanHelper(const string& word, int length, int cell, int node, CellSet& marked,
+                         Vector<int>& path) const {
+    // Base Cases: if all letters are formed, word found!
+    if (length == (int) word.length()) return true;
 
-    // Base Cases: if word only 1 letter, it means formed now is a complete word, so word found!
-    if (word.length() == 1) return true;
+    char next = word[length];  // get the next letter of word
 
-    // generate all available neighbors of current gird
-    Vector<neigborT> nList = neigborsOf(row, col);
-
-    // for each available neighbor of current grid
-    for (int i = 0; i < nList.size(); i++) {
-        char neiToTry = nList[i].letter;   // choose a availabe negihbor
-        int nRow = nList[i].row;           // neigbor's row
-        int nCol = nList[i].col;           // neigbor's col
+    // for each neighbor of current cell
+    for (int i = adjacency->start[cell]; i < adjacency->start[cell + 1]; i++) {
+        int neighbor = adjacency->neighbors[i];   // choose a negihbor
 
         // each time meets a marked(used) neighbor, skip it.
-        if (marked[nRow][nCol] == 'X') continue;
-
-        BoggleGUI::setHighlighted(nRow, nCol, true);       // hightlight the chosen neighbor
+        if (marked.contains(neighbor)) continue;
 
-        // if the neighbor is exactly the next letter , fomred is in dictionary, and unmarked:
-        if (neiToTry == next && boggleDict.containsPrefix(formed + next)) {
+        // if the neighbor is exactly the next letter and formed is a prefix in dictionary:
+        int nextNode = cells[neighbor] == next ? boggleDict->child(node, next) : -1;
+        if (nextNode >= 0) {
 
             // Choose:
-            marked.set(nRow, nCol, 'X');                   // mark the neigbor
-            BoggleGUI::setHighlighted(nRow, nCol, true);   // hightlight the choosen negihbor
+            marked.add(neighbor);                          // mark the neigbor
+            path.add(neighbor);
 
             // Explore: the rest by recursion, return true if found!
-            if (humanHelper(word.substr(1), formed + next, nRow, nCol, marked)) return true;
+            if (humanHelper(word, length + 1, neighbor, nextNode, marked, path)) return true;
 
             // Un-choose:
-            marked.set(nRow, nCol, ' ');                   // un-mark the neigbor
-            BoggleGUI::setHighlighted(nRow, nCol, false);  // un-hightlight every un-choosen path
+            path.remove(path.size() - 1);
+            marked.remove(neighbor);                       // un-mark the neigbor
         }
-
-        BoggleGUI::setHighlighted(nRow, nCol, false);      // un-hightlight the choosen negihbor
     }
     return false;  // all neigbors have tried, return false.
 }
 
-Vector<neigborT> Boggle::neigborsOf(int row, int col) const {
-    Vector<neigborT> neighborList;
-    neigborT newNeigbor;
-
-    for (int r = row-1; r <= row+1; r++) {
-        for (int c = col-1; c <= col+1; c++) {
-            if (r != row || c != col ) {            // don't want itself
-                if (boggleBoard.inBounds(r, c)) {   // must be inside the board
-                    newNeigbor.row = r;
-                    newNeigbor.col = c;
-                    newNeigbor.letter = boggleBoard[r][c];
-                    neighborList.add(newNeigbor);
-                }
-            }
-        }
+void Boggle::animatePath(const Vector<int>& path) const {
+    BoggleGUI::setAnimationDelay(100);  // set GUI delay time
+    BoggleGUI::clearHighlighting();     // un-highlight the last word's path
+    for (int cell : path) {
+        BoggleGUI::setHighlighted(cell / adjacency->cols, cell % adjacency->cols, true);
     }
-    return neighborList;
 }
 
 Set<string> Boggle::computerWordSearch() {
     Set<string> result; // all words found by computer
-    Grid<char> used;    // a separate grid to record used grid, 'X' means used.
-    used.resize(4, 4);
+    Vector<string> allWords;
+    solver.solve(cells, &allWords);
 
-    for (int c = 0; c < boggleBoard.nCols; c++) {
-        for (int r = 0; r < boggleBoard.nRows; r++) {
-            string formed = "";
-            formed += getLetter(c, r); // get the visted formed letter
-            used.set(c, r, 'X');       // marked it as used
-            computerHelper(c, r, formed, used, result);
-            used.set(c, r, ' ');       // un-marked it
-        }
+    // the computer does not get the words the human found already
+    for (const string& word : allWords) {
+        if (!wordsHuman.contains(word)) result.add(word);
     }
     wordsComputer = result; // update computer's word set.
 
     return result;
 }
 
-
-void Boggle::computerHelper(int row, int col, string formed,
-                            Grid<char>& used, Set<string>& result) {
-    // Base cases:
-    if (checkWord(formed)) result.add(formed); // Found word! add into words' set!
-
-    // Find all available neigbors of current gird.
-    Vector<neigborT> neigList = neigborsOf(row, col);
-    int neigSize = neigList.size();
-
-    // Keep searching if board[row][col] have neigbors,
-    if (neigSize > 0){
-        
-        // for each neighbor
-        for (int i = 0; i < neigSize; i++) {
-            // choose a neigbor
-            char neigh = neigList[i].letter;
-            int nRow = neigList[i].row;
-            int nCol = neigList[i].col;
-            if (boggleDict.containsPrefix(formed + neigh) && used[nRow][nCol] != 'X') {
-                // if is the neighbor contians valid prefix and not used
-                used.set(nRow, nCol, 'X'); // marked as used
-                computerHelper(nRow, nCol, formed + neigh, used, result); // explore next by recursion
-                used.set(nRow, nCol, ' '); // unmark it
-            }
-        }
-        
-    }
-
-}
-
 int Boggle::scoreAward(const Set<string>& wordsList) const {
     int score = 0;
     for (string word : wordsList) {
@@ -235,11 +187,11 @@ Set<string> Boggle::getWordsFound(const PlayerT& player) const {
 }
 
 ostream& operator<<(ostream& out, Boggle& boggle) {
-    for (int r = 0; r < 4; r++) {
-        for(int c = 0; c < 4; c++) {
+    for (int r = 0; r < boggle.boggleBoard.nRows; r++) {
+        for(int c = 0; c < boggle.boggleBoard.nCols; c++) {
             out << boggle.getLetter(r, c);
-            if ((c+1) % 4 == 0) out << endl;
         }
+        out << endl;
     }
     return out;
 }
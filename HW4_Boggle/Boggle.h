@@ -11,8 +11,13 @@
 #ifndef _boggle_h
 #define _boggle_h
 
+#include <future>
 #include <iostream>
+#include <memory>
 #include <string>
+#include "boggleboard.h"
+#include "bogglesolver.h"
+#include "../Shared/compactlexicon.h"
 #include "lexicon.h"
 #include "grid.h"
 #include "bogglegui.h"
@@ -22,18 +27,19 @@ using namespace std;
 
 enum PlayerT {Human, Computer};
 
-struct neigborT {
-    char letter;
-    int row = 0;
-    int col = 0;
-};
+// How humanWordSearch shows the path of a word it found. AnimateInBackground calls
+// BoggleGUI from another thread, which the GUI does not guard against: use it only
+// while nothing else draws on the board, such as from a console-only driver.
+enum AnimationT {AnimateNow, AnimateInBackground, NoAnimation};
 
 class Boggle {
 public:
     /*
-     * Constrct a game board according to boardText string.
+     * Constrct a rows x cols game board according to boardText string, row by row;
+     * an empty boardText is filled with a random board. Games can share one dictionary,
+     * such as one opened from a compiled dictionary file.
      */
-    Boggle(Lexicon& dictionary, string& boardText);
+    Boggle(shared_ptr<const CompactLexicon> dictionary, string& boardText, int rows = 4, int cols = 4);
 
     /*
      * Check if the given word is suitable to search for.
@@ -41,9 +47,17 @@ public:
     bool checkWord(string word);
 
     /*
-     * Cheack if the user-input word can be formed in boggle board.
+     * Cheack if the user-input word can be formed in boggle board, and if so record it
+     * and show its path on the GUI: before returning, on a background thread (one
+     * animation at a time), or not at all.
+     */
+    bool humanWordSearch(string word, AnimationT animation = AnimateNow);
+
+    /*
+     * Find the cells of a path that spells word, row * cols + col in order, without
+     * touching the GUI; return false if there is none. Safe to call from many threads.
      */
-    bool humanWordSearch(string word);
+    bool findWordPath(string word, Vector<int>& path) const;
 
     /*
      * perform a search on the board for all words that can be formed
@@ -77,31 +91,30 @@ public:
 
 private:
     /*
-     * Helper for humanWordSearch().
-     */
-    bool humanHelper(string word, string formed,
-                     int row, int col, Grid<char>& marked) const;
-
-    /*
-     * Helper for computerWordSearch().
+     * Helper for findWordPath(): the first length letters of word are formed along
+     * path, ending on cell, and node is their dictionary node.
      */
-    void computerHelper(int row, int col, string formed,
-                        Grid<char>& used, Set<string>& result);
+    bool humanHelper(const string& word, int length, int cell, int node, CellSet& marked,
+                     Vector<int>& path) const;
 
     /*
-     * Find all neighbors of a specified grid in boggle board, called by humanHelper().
+     * Clear the highlighting, then highlight the cells of path on the GUI one by one.
      */
-    Vector<neigborT> neigborsOf(int row, int col) const;
+    void animatePath(const Vector<int>& path) const;
 
     /*
      * Adward score by words so far, called by getScoreHuman() and getScoreComputer().
      */
     int scoreAward(const Set<string>& wordsList) const;
 
-    Lexicon boggleDict;         // boggle dictionary
+    shared_ptr<const CompactLexicon> boggleDict; // boggle dictionary, shared between games
     Grid<char> boggleBoard;     // boggle board
+    string cells;               // boggle board letters, cell row * cols + col
+    shared_ptr<const BoardAdjacency> adjacency; // neighbours of each cell
+    BoggleSolver solver;        // computer's word search
     Set<string> wordsHuman;     // human words list
     Set<string> wordsComputer;  // human words list
+    future<void> animation;     // background animation of the last word found
 };
 
 #endif // _boggle_h
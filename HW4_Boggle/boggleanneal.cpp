@@ -0,0 +1,221 @@
+//
+//  boggleanneal.cpp
+//
+//  Also a command-line tool that prints the best board found and the search's
+//  throughput. Built on its own (define BOGGLE_ANNEAL_MAIN) so it does not clash with
+//  the game's main.
+//
+//  Created by Jian Zhong on 7/29/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#include "boggleanneal.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "bogglesolver.h"
+#include "error.h"
+#include "strlib.h"
+
+/* What one run found */
+struct AnnealRun {
+    string board;
+    int score = -1;
+    long long solves = 0;
+};
+
+// Function Prototypes:
+AnnealRun annealRun(BoggleSolver&, const AnnealSettings&, uint64_t);
+
+AnnealRun annealRun(BoggleSolver& solver, const AnnealSettings& settings, uint64_t run) {
+    uint64_t state = settings.seed ^ (run * 0xd1b54a32d192ed03ULL);
+    nextRandom(state); // scramble the start state
+
+    // the starting roll: cube and face up of every cell
+    int numCells = settings.rows * settings.cols;
+    vector<int> cube(numCells), face(numCells);
+    string board(numCells, ' ');
+    int order[16];
+    for (int pos = 0; pos < numCells; pos++) {
+        if (pos % 16 == 0) {
+            for (int i = 0; i < 16; i++) order[i] = i;
+            for (int i = 15; i > 0; i--) swap(order[i], order[nextRandom(state) % (i + 1)]);
+        }
+        cube[pos] = order[pos % 16];
+        face[pos] = nextRandom(state) % 6;
+        board[pos] = CUBES[cube[pos]][face[pos]];
+    }
+
+    AnnealRun best;
+    int score = solver.solve(board);
+    best.board = board;
+    best.score = score;
+    best.solves = 1;
+
+    // the temperature falls geometrically from start to end over the run
+    double temperature = settings.startTemperature;
+    double cooling = settings.steps > 1 ? pow(settings.endTemperature / settings.startTemperature,
+                                              1.0 / (settings.steps - 1)) : 1;
+    for (int step = 0; step < settings.steps; step++, temperature *= cooling) {
+        int a = nextRandom(state) % numCells;
+        int b = -1;  // the other cube of a swap
+        int oldFace = face[a];
+        bool changed;
+        // turn a cube to another face or swap two cubes, so the board stays a roll of CUBES
+        if (numCells < 2 || nextRandom(state) % 2 == 0) {
+            face[a] = (face[a] + 1 + nextRandom(state) % 5) % 6; // any other face
+            changed = CUBES[cube[a]][face[a]] != board[a];
+            board[a] = CUBES[cube[a]][face[a]];
+        } else {
+            b = nextRandom(state) % (numCells - 1);
+            if (b >= a) b++;
+            changed = board[a] != board[b];
+            swap(cube[a], cube[b]);
+            swap(face[a], face[b]);
+            swap(board[a], board[b]);
+        }
+
+        // a board with the same letters has the same score
+        int newScore = score;
+        if (changed) {
+            newScore = solver.solve(board);
+            best.solves++;
+        }
+
+        // a move that loses points is still taken with probability e^(change / temperature)
+        double chance = (double) (nextRandom(state) >> 11) * 0x1.0p-53; // uniform in [0, 1)
+        if (newScore >= score || chance < exp((newScore - score) / temperature)) {
+            score = newScore;
+            if (score > best.score) {
+                best.score = score;
+                best.board = board;
+            }
+        } else if (b < 0) {  // undo the move
+            face[a] = oldFace;
+            board[a] = CUBES[cube[a]][face[a]];
+        } else {
+            swap(cube[a], cube[b]);
+            swap(face[a], face[b]);
+            swap(board[a], board[b]);
+        }
+    }
+    return best;
+}
+
+AnnealResult annealBoards(shared_ptr<const CompactLexicon> dictionary, const AnnealSettings& settings) {
+    if (settings.rows <= 0 || settings.cols <= 0) error("annealBoards: the board is empty");
+    if (settings.restarts <= 0) error("annealBoards: there must be at least one run");
+    if (settings.startTemperature <= 0 || settings.endTemperature <= 0) {
+        error("annealBoards: temperatures must be positive");
+    }
+
+    int numRuns = settings.restarts;
+    vector<AnnealRun> runs(numRuns);
+    int numThreads = settings.numThreads;
+    if (numThreads <= 0) numThreads = max(1, (int) thread::hardware_concurrency());
+    numThreads = max(1, min(numThreads, numRuns));
+
+    auto startTime = chrono::steady_clock::now();
+    atomic<int> nextRun(0);
+    auto worker = [&]() {
+        BoggleSolver solver(dictionary, settings.rows, settings.cols);
+        for (int run = nextRun++; run < numRuns; run = nextRun++) {
+            runs[run] = annealRun(solver, settings, run);
+        }
+    };
+
+    std::vector<thread> workers;
+    for (int t = 1; t < numThreads; t++) {
+        workers.emplace_back(worker);
+    }
+    worker(); // the calling thread takes a share too
+    for (thread& t : workers) {
+        t.join();
+    }
+
+    // the best run, the first one on ties, so that threads do not change the answer
+    AnnealResult result;
+    for (int run = 0; run < numRuns; run++) {
+        if (runs[run].score > result.score) {
+            result.board = runs[run].board;
+            result.score = runs[run].score;
+            result.run = run;
+        }
+        result.solves += runs[run].solves;
+    }
+    result.steps = (long long) numRuns * max(0, settings.steps);
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    result.numThreads = numThreads;
+    return result;
+}
+
+#ifdef BOGGLE_ANNEAL_MAIN
+/*
+ * Usage: boggleanneal DICTIONARY [-size ROWSxCOLS] [-restarts N] [-steps N] [-seed N]
+ *                     [-threads N] [-temperature START END]
+ * DICTIONARY is a word list or a dictionary compiled by lexiconcompile.
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "usage: " << argv[0] << " DICTIONARY [-size ROWSxCOLS] [-restarts N] [-steps N]"
+             << " [-seed N] [-threads N] [-temperature START END]" << endl;
+        return 1;
+    }
+
+    AnnealSettings settings;
+    for (int i = 2; i < argc; i++) {
+        string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "-size" && hasValue) {
+            Vector<string> size = stringSplit(argv[++i], "x");
+            if (size.size() != 2) {
+                cerr << "bad size " << argv[i] << endl;
+                return 1;
+            }
+            settings.rows = stringToInteger(size[0]);
+            settings.cols = stringToInteger(size[1]);
+        } else if (option == "-restarts" && hasValue) {
+            settings.restarts = atoi(argv[++i]);
+        } else if (option == "-steps" && hasValue) {
+            settings.steps = atoi(argv[++i]);
+        } else if (option == "-seed" && hasValue) {
+            settings.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (option == "-threads" && hasValue) {
+            settings.numThreads = atoi(argv[++i]);
+        } else if (option == "-temperature" && i + 2 < argc) {
+            settings.startTemperature = atof(argv[++i]);
+            settings.endTemperature = atof(argv[++i]);
+        } else {
+            cerr << "unknown option " << option << endl;
+            return 1;
+        }
+    }
+
+    shared_ptr<const CompactLexicon> dictionary = CompactLexicon::open(argv[1]);
+    AnnealResult result = annealBoards(dictionary, settings);
+
+    // the board row by row, then its words
+    for (int r = 0; r < settings.rows; r++) {
+        cout << result.board.substr(r * settings.cols, settings.cols) << endl;
+    }
+    Vector<string> words;
+    BoggleSolver solver(dictionary, settings.rows, settings.cols);
+    solver.solve(result.board, &words);
+    cout << "score " << result.score << ", " << words.size() << " words (run " << result.run << ")" << endl;
+    for (int w = 0; w < words.size(); w++) {
+        cout << (w > 0 ? " " : "") << words[w];
+    }
+    cout << endl;
+
+    double perSecond = result.seconds > 0 ? result.solves / result.seconds : 0;
+    cerr << result.steps << " moves, " << result.solves << " solves in " << result.seconds << " s ("
+         << perSecond << " solves/s, " << perSecond / result.numThreads << " per thread on "
+         << result.numThreads << " threads)" << endl;
+    return 0;
+}
+#endif // BOGGLE_ANNEAL_MAIN
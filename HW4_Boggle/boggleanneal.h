@@ -0,0 +1,52 @@
+//
+//  boggleanneal.h
+//
+//  Searches for high-scoring Boggle boards by simulated annealing: every run starts
+//  from a random roll of CUBES and keeps re-rolling single cubes or swapping two of
+//  them, scoring each new board with a BoggleSolver. Runs are independent, so they
+//  are spread over threads, and the search reports how many boards it solved per second.
+//
+//  Created by Jian Zhong on 7/29/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#ifndef _boggleanneal_h
+#define _boggleanneal_h
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "../Shared/compactlexicon.h"
+
+using namespace std;
+
+/* How to search */
+struct AnnealSettings {
+    int rows = 4;
+    int cols = 4;
+    int restarts = 8;               // independent runs, each from its own random board
+    int steps = 100000;             // moves tried per run
+    double startTemperature = 10;   // a move losing this many points is taken 1 time in e at the start,
+    double endTemperature = 0.2;    // and 1 time in e when losing this many at the end
+    uint64_t seed = 1;
+    int numThreads = 0;             // 0 means one per core
+};
+
+/* The best board found, and the work it took */
+struct AnnealResult {
+    string board;                   // row by row
+    int score = -1;
+    int run = -1;                   // the run that found board
+    long long steps = 0;            // moves tried by all runs
+    long long solves = 0;           // boards solved by all runs; moves that change no letter need none
+    double seconds = 0;             // wall-clock time
+    int numThreads = 0;
+};
+
+/*
+ * Run settings.restarts annealing searches and return the best board of them all. The
+ * result depends only on the settings and the dictionary, not on the number of threads.
+ */
+AnnealResult annealBoards(shared_ptr<const CompactLexicon> dictionary, const AnnealSettings& settings);
+
+#endif // _boggleanneal_h
@@ -0,0 +1,172 @@
+//
+//  bogglebatch.cpp
+//
+//  Command-line batch solver: solves boards read from a file, or random boards rolled
+//  from CUBES with a seed, and prints each board's score and words. Built on its own
+//  (define BOGGLE_BATCH_MAIN) so it does not clash with the game's main.
+//
+//  Created by Jian Zhong on 7/24/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "bogglesolver.h"
+#include "../Shared/compactlexicon.h"
+#include "strlib.h"
+
+using namespace std;
+
+// Number of boards solved and printed at a time.
+const int BATCH_SIZE = 1 << 16;
+
+// Function Prototypes:
+bool readBoards(istream&, Vector<string>&, int, int, int&);
+void printResults(const Vector<string>&, const Vector<BoggleResult>&, bool);
+
+bool readBoards(istream& input, Vector<string>& boards, int count, int numCells, int& lineNumber) {
+    boards.clear();
+    string line;
+    while (boards.size() < count && getline(input, line)) {
+        lineNumber++;
+        line = toUpperCase(trim(line));
+        if (line.empty()) continue;
+        if ((int) line.length() != numCells) {
+            throw "line " + integerToString(lineNumber) + ": the board does not have "
+                    + integerToString(numCells) + " letters.";
+        }
+        boards.add(line);
+    }
+    return !boards.isEmpty();
+}
+
+void printResults(const Vector<string>& boards, const Vector<BoggleResult>& results, bool scoresOnly) {
+    for (int i = 0; i < boards.size(); i++) {
+        cout << boards[i] << '\t' << results[i].score << '\t' << results[i].wordCount;
+        if (!scoresOnly) {
+            cout << '\t';
+            for (int w = 0; w < results[i].words.size(); w++) {
+                if (w > 0) cout << ' ';
+                cout << results[i].words[w];
+            }
+        }
+        cout << '\n';
+    }
+}
+
+#ifdef BOGGLE_BATCH_MAIN
+/*
+ * Usage: bogglebatch DICTIONARY (-boards FILE | -random COUNT [-seed N])
+ *                    [-size ROWSxCOLS] [-threads N] [-scores | -quiet]
+ * DICTIONARY is a word list or a dictionary compiled by lexiconcompile.
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "usage: " << argv[0] << " DICTIONARY (-boards FILE | -random COUNT [-seed N])"
+             << " [-size ROWSxCOLS] [-threads N] [-scores | -quiet]" << endl;
+        return 1;
+    }
+
+    string boardFile;
+    long long randomCount = -1;
+    unsigned long long seed = 1;
+    int rows = 4, cols = 4, numThreads = 0;
+    bool scoresOnly = false, quiet = false;
+    for (int i = 2; i < argc; i++) {
+        string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "-boards" && hasValue) {
+            boardFile = argv[++i];
+        } else if (option == "-random" && hasValue) {
+            randomCount = atoll(argv[++i]);
+        } else if (option == "-seed" && hasValue) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (option == "-size" && hasValue) {
+            Vector<string> size = stringSplit(argv[++i], "x");
+            if (size.size() != 2) {
+                cerr << "bad size " << argv[i] << endl;
+                return 1;
+            }
+            rows = stringToInteger(size[0]);
+            cols = stringToInteger(size[1]);
+        } else if (option == "-threads" && hasValue) {
+            numThreads = atoi(argv[++i]);
+        } else if (option == "-scores") {
+            scoresOnly = true;
+        } else if (option == "-quiet") {
+            quiet = true;
+        } else {
+            cerr << "unknown option " << option << endl;
+            return 1;
+        }
+    }
+    if (boardFile.empty() == (randomCount < 0)) {
+        cerr << "give either -boards or -random" << endl;
+        return 1;
+    }
+
+    ios::sync_with_stdio(false);
+    shared_ptr<const CompactLexicon> dictionary = CompactLexicon::open(argv[1]);
+
+    ifstream input;
+    if (!boardFile.empty()) {
+        input.open(boardFile);
+        if (!input) {
+            cerr << "cannot open " << boardFile << endl;
+            return 1;
+        }
+    }
+
+    auto startTime = chrono::steady_clock::now();
+    long long solved = 0, totalScore = 0;
+    int bestScore = -1, lineNumber = 0;
+    string bestBoard;
+    Vector<string> boards;
+    try {
+        for (;;) {
+            // the next batch of boards
+            if (randomCount >= 0) {
+                boards.clear();
+                for (int i = 0; i < BATCH_SIZE && solved + i < randomCount; i++) {
+                    boards.add(randomBoard(rows, cols, seed, solved + i));
+                }
+                if (boards.isEmpty()) break;
+            } else if (!readBoards(input, boards, BATCH_SIZE, rows * cols, lineNumber)) {
+                break;
+            }
+
+            Vector<BoggleResult> results = solveBoards(dictionary, boards, rows, cols,
+                                                       !scoresOnly && !quiet, numThreads);
+            if (!quiet) printResults(boards, results, scoresOnly);
+
+            for (int i = 0; i < results.size(); i++) {
+                totalScore += results[i].score;
+                if (results[i].score > bestScore) {
+                    bestScore = results[i].score;
+                    bestBoard = boards[i];
+                }
+            }
+            solved += boards.size();
+        }
+    } catch (const string& message) {
+        cout.flush();
+        cerr << boardFile << ", " << message << endl;
+        return 1;
+    } catch (const char* message) {
+        cout.flush();
+        cerr << message << endl;
+        return 1;
+    }
+    cout.flush();
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    cerr << solved << " boards in " << seconds << " s (" << (seconds > 0 ? solved / seconds : 0)
+         << " boards/s), mean score " << (solved > 0 ? (double) totalScore / solved : 0)
+         << ", best " << bestBoard << " (" << bestScore << ")" << endl;
+    return 0;
+}
+#endif // BOGGLE_BATCH_MAIN
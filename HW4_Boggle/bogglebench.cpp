@@ -0,0 +1,356 @@
+//
+//  bogglebench.cpp
+//
+//  Benchmark of the computer's word search: solves a fixed set of seeded random
+//  boards with the original Lexicon recursion and with each optimized solver, checks
+//  that they all find the same words, and reports boards per second, nodes visited
+//  and prefix lookups per board, and the cost of a single prefix lookup. Then makes
+//  seeded random single-cube edits with changeCell and checks each one against a
+//  fresh solve. Built on its own (define BOGGLE_BENCH_MAIN) so it does not clash with
+//  the game's main.
+//
+//  Created by Jian Zhong on 8/5/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Boggle.h"
+#include "boggleboard.h"
+#include "bogglesolver.h"
+#include "../Shared/compactlexicon.h"
+#include "lexicon.h"
+#include "set.h"
+#include "strlib.h"
+
+using namespace std;
+
+/* The words found on every board by one solver, and the work it took */
+struct BenchRun {
+    string name;
+    Vector<Set<string> > words;     // per board
+    SolveStats stats;
+    double seconds = 0;
+};
+
+/* Single-cube edits made with changeCell, and how many disagreed with solve() */
+struct EditRun {
+    int edits = 0;
+    int mismatches = 0;
+    double changeSeconds = 0;
+    double solveSeconds = 0;
+};
+
+/* State of the original recursion on one board */
+struct LexiconSearch {
+    const Lexicon* dictionary;
+    const string* board;
+    const BoardAdjacency* adjacency;
+    CellSet used;
+    Set<string> found;
+    SolveStats stats;
+    Vector<string>* prefixes = nullptr;    // if not null, every prefix looked up is added
+};
+
+// Function Prototypes:
+void lexiconSearch(LexiconSearch&, const string&);
+void lexiconHelper(LexiconSearch&, int, const string&);
+BenchRun runLexicon(const Lexicon&, const Vector<string>&, int, int);
+BenchRun runSolver(shared_ptr<const CompactLexicon>, const Vector<string>&, int, int, bool);
+BenchRun runGame(shared_ptr<const CompactLexicon>, const Vector<string>&, int, int);
+EditRun runEdits(shared_ptr<const CompactLexicon>, const Vector<string>&, int, int, int, uint64_t);
+Vector<string> lookedUpPrefixes(const Lexicon&, const Vector<string>&, int, int);
+int countMismatches(const BenchRun&, const BenchRun&);
+void printRun(const BenchRun&, int);
+
+void lexiconSearch(LexiconSearch& search, const string& board) {
+    search.board = &board;
+    search.used.reset(board.length());
+    for (int cell = 0; cell < (int) board.length(); cell++) {
+        string formed(1, board[cell]);
+        search.stats.prefixLookups++;
+        if (search.prefixes != nullptr) search.prefixes->add(formed);
+        if (!search.dictionary->containsPrefix(formed)) continue;
+
+        search.used.add(cell);
+        lexiconHelper(search, cell, formed);
+        search.used.remove(cell);
+    }
+}
+
+void lexiconHelper(LexiconSearch& search, int cell, const string& formed) {
+    search.stats.nodesVisited++;
+    if ((int) formed.length() >= MIN_WORD_LENGTH) {
+        search.stats.prefixLookups++;
+        if (search.dictionary->contains(formed)) search.found.add(formed);
+    }
+
+    const BoardAdjacency& adjacency = *search.adjacency;
+    for (int i = adjacency.start[cell]; i < adjacency.start[cell + 1]; i++) {
+        int neighbor = adjacency.neighbors[i];
+        if (search.used.contains(neighbor)) continue;
+
+        string next = formed + (*search.board)[neighbor];
+        search.stats.prefixLookups++;
+        if (search.prefixes != nullptr) search.prefixes->add(next);
+        if (!search.dictionary->containsPrefix(next)) continue;
+
+        search.used.add(neighbor);
+        lexiconHelper(search, neighbor, next);
+        search.used.remove(neighbor);
+    }
+}
+
+BenchRun runLexicon(const Lexicon& dictionary, const Vector<string>& boards, int rows, int cols) {
+    BenchRun run;
+    run.name = "lexicon recursion";
+    shared_ptr<const BoardAdjacency> adjacency = BoardAdjacency::forSize(rows, cols);
+
+    auto startTime = chrono::steady_clock::now();
+    for (const string& board : boards) {
+        LexiconSearch search;
+        search.dictionary = &dictionary;
+        search.adjacency = adjacency.get();
+        lexiconSearch(search, board);
+        run.words.add(search.found);
+        run.stats.nodesVisited += search.stats.nodesVisited;
+        run.stats.prefixLookups += search.stats.prefixLookups;
+    }
+    run.seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    return run;
+}
+
+BenchRun runSolver(shared_ptr<const CompactLexicon> dictionary, const Vector<string>& boards,
+                   int rows, int cols, bool incremental) {
+    BenchRun run;
+    run.name = incremental ? "solveIncremental" : "BoggleSolver";
+    BoggleSolver solver(dictionary, rows, cols);
+    Vector<Vector<string> > lists(boards.size());
+
+    auto startTime = chrono::steady_clock::now();
+    for (int i = 0; i < boards.size(); i++) {
+        if (incremental) {
+            solver.solveIncremental(boards[i]);
+            solver.getWords(lists[i]);
+        } else {
+            solver.solve(boards[i], &lists[i]);
+        }
+    }
+    run.seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    run.stats = solver.getStats();
+
+    for (const Vector<string>& list : lists) {
+        Set<string> words;
+        for (const string& word : list) {
+            words.add(word);
+        }
+        run.words.add(words);
+    }
+    return run;
+}
+
+BenchRun runGame(shared_ptr<const CompactLexicon> dictionary, const Vector<string>& boards, int rows, int cols) {
+    BenchRun run;
+    run.name = "computerWordSearch";
+
+    auto startTime = chrono::steady_clock::now();
+    for (string board : boards) {
+        Boggle game(dictionary, board, rows, cols);
+        run.words.add(game.computerWordSearch());
+    }
+    run.seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    return run;
+}
+
+EditRun runEdits(shared_ptr<const CompactLexicon> dictionary, const Vector<string>& boards,
+                 int rows, int cols, int editsPerBoard, uint64_t seed) {
+    EditRun run;
+    BoggleSolver incremental(dictionary, rows, cols);
+    BoggleSolver solver(dictionary, rows, cols);
+    uint64_t state = seed;
+
+    for (const string& board : boards) {
+        incremental.solveIncremental(board);
+        for (int e = 0; e < editsPerBoard; e++) {
+            int cell = nextRandom(state) % (rows * cols);
+            char letter = 'A' + nextRandom(state) % 26;
+
+            auto startTime = chrono::steady_clock::now();
+            int score = incremental.changeCell(cell, letter);
+            auto changedTime = chrono::steady_clock::now();
+            Vector<string> expected;
+            int expectedScore = solver.solve(incremental.getBoard(), &expected);
+            auto solvedTime = chrono::steady_clock::now();
+            run.changeSeconds += chrono::duration<double>(changedTime - startTime).count();
+            run.solveSeconds += chrono::duration<double>(solvedTime - changedTime).count();
+            run.edits++;
+
+            Vector<string> words;
+            incremental.getWords(words);
+            if (score != expectedScore || incremental.getWordCount() != solver.getWordCount()
+                    || words != expected) {
+                if (run.mismatches == 0) {
+                    cerr << "changeCell differs first on board " << board << " after setting cell "
+                         << cell << " to " << letter << endl;
+                }
+                run.mismatches++;
+            }
+        }
+    }
+    return run;
+}
+
+Vector<string> lookedUpPrefixes(const Lexicon& dictionary, const Vector<string>& boards, int rows, int cols) {
+    shared_ptr<const BoardAdjacency> adjacency = BoardAdjacency::forSize(rows, cols);
+    Vector<string> prefixes;
+    for (const string& board : boards) {
+        LexiconSearch search;
+        search.dictionary = &dictionary;
+        search.adjacency = adjacency.get();
+        search.prefixes = &prefixes;
+        lexiconSearch(search, board);
+    }
+    return prefixes;
+}
+
+int countMismatches(const BenchRun& expected, const BenchRun& actual) {
+    int mismatches = 0;
+    for (int i = 0; i < expected.words.size(); i++) {
+        if (expected.words[i] != actual.words[i]) {
+            if (mismatches == 0) cerr << actual.name << " differs first on board " << i << endl;
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+void printRun(const BenchRun& run, int numBoards) {
+    double perBoard = run.seconds / numBoards;
+    cout << setw(20) << left << run.name << right << fixed
+         << setw(12) << setprecision(0) << numBoards / run.seconds
+         << setw(12) << setprecision(1) << perBoard * 1e6;
+    if (run.stats.prefixLookups > 0) {
+        cout << setw(14) << setprecision(1) << (double) run.stats.nodesVisited / numBoards
+             << setw(14) << setprecision(1) << (double) run.stats.prefixLookups / numBoards
+             << setw(12) << setprecision(1) << run.seconds * 1e9 / run.stats.prefixLookups;
+    }
+    cout << endl;
+}
+
+#ifdef BOGGLE_BENCH_MAIN
+/*
+ * Usage: bogglebench DICTIONARY [-boards N] [-seed N] [-size ROWSxCOLS] [-edits N]
+ * DICTIONARY is a word list; the optimized solvers build their compact form of it.
+ * -edits is the number of changeCell edits made to every board.
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "usage: " << argv[0] << " DICTIONARY [-boards N] [-seed N] [-size ROWSxCOLS] [-edits N]" << endl;
+        return 1;
+    }
+
+    int numBoards = 2000, rows = 4, cols = 4, editsPerBoard = 10;
+    unsigned long long seed = 1;
+    for (int i = 2; i < argc; i++) {
+        string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "-boards" && hasValue) {
+            numBoards = atoi(argv[++i]);
+        } else if (option == "-seed" && hasValue) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (option == "-size" && hasValue) {
+            Vector<string> size = stringSplit(argv[++i], "x");
+            if (size.size() != 2) {
+                cerr << "bad size " << argv[i] << endl;
+                return 1;
+            }
+            rows = stringToInteger(size[0]);
+            cols = stringToInteger(size[1]);
+        } else if (option == "-edits" && hasValue) {
+            editsPerBoard = atoi(argv[++i]);
+        } else {
+            cerr << "unknown option " << option << endl;
+            return 1;
+        }
+    }
+    if (numBoards <= 0) {
+        cerr << "there must be at least one board" << endl;
+        return 1;
+    }
+
+    Lexicon lexicon(argv[1]);
+    auto startTime = chrono::steady_clock::now();
+    shared_ptr<const CompactLexicon> dictionary = make_shared<const CompactLexicon>(lexicon);
+    double buildSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    cout << lexicon.size() << " words; compact dictionary of " << dictionary->numNodes()
+         << " nodes built in " << buildSeconds << " s" << endl;
+
+    Vector<string> boards;
+    for (int i = 0; i < numBoards; i++) {
+        boards.add(randomBoard(rows, cols, seed, i));
+    }
+
+    Vector<BenchRun> runs;
+    runs.add(runLexicon(lexicon, boards, rows, cols));
+    runs.add(runSolver(dictionary, boards, rows, cols, false));
+    runs.add(runSolver(dictionary, boards, rows, cols, true));
+    runs.add(runGame(dictionary, boards, rows, cols));
+
+    cout << numBoards << " boards of " << rows << "x" << cols << ", seed " << seed << endl;
+    cout << setw(20) << left << "solver" << right << setw(12) << "boards/s" << setw(12) << "us/board"
+         << setw(14) << "nodes/board" << setw(14) << "lookups/board" << setw(12) << "ns/lookup" << endl;
+    for (const BenchRun& run : runs) {
+        printRun(run, numBoards);
+    }
+
+    // the cost of one lookup on its own: the whole prefix from the root, or one step
+    // from the node of the prefix without its last letter
+    Vector<string> prefixes = lookedUpPrefixes(lexicon, boards, rows, cols);
+    std::vector<int> parents(prefixes.size());
+    for (int i = 0; i < prefixes.size(); i++) {
+        const string& prefix = prefixes[i];
+        parents[i] = dictionary->find(prefix.substr(0, prefix.length() - 1));
+    }
+    long long hits = 0;
+    startTime = chrono::steady_clock::now();
+    for (const string& prefix : prefixes) {
+        hits += lexicon.containsPrefix(prefix);
+    }
+    double lexiconSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    startTime = chrono::steady_clock::now();
+    for (const string& prefix : prefixes) {
+        hits -= dictionary->containsPrefix(prefix);
+    }
+    double findSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    long long steps = 0;
+    startTime = chrono::steady_clock::now();
+    for (int i = 0; i < prefixes.size(); i++) {
+        if (parents[i] >= 0) steps += dictionary->child(parents[i], prefixes[i].back()) >= 0;
+    }
+    double stepSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    if (hits != 0) cerr << "the dictionaries disagree on some prefixes" << endl;
+    cout << prefixes.size() << " prefix lookups: Lexicon " << lexiconSeconds * 1e9 / prefixes.size()
+         << " ns, compact from the root " << findSeconds * 1e9 / prefixes.size()
+         << " ns, compact cursor step " << stepSeconds * 1e9 / prefixes.size() << " ns ("
+         << steps << " found)" << endl;
+
+    EditRun edits = runEdits(dictionary, boards, rows, cols, editsPerBoard, seed);
+    if (edits.edits > 0) {
+        cout << edits.edits << " single-cube edits: changeCell " << edits.changeSeconds * 1e6 / edits.edits
+             << " us, solve " << edits.solveSeconds * 1e6 / edits.edits << " us, "
+             << edits.mismatches << " disagreed" << endl;
+    }
+
+    int mismatches = 0;
+    for (int r = 1; r < runs.size(); r++) {
+        mismatches += countMismatches(runs[0], runs[r]);
+    }
+    cout << (mismatches == 0 ? "all solvers found the same words" : "the solvers found different words") << endl;
+    return mismatches == 0 && edits.mismatches == 0 ? 0 : 1;
+}
+#endif // BOGGLE_BENCH_MAIN
@@ -0,0 +1,41 @@
+//
+//  boggleboard.cpp
+//
+//  Created by Jian Zhong on 7/22/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#include "boggleboard.h"
+#include <map>
+#include <mutex>
+#include <utility>
+
+shared_ptr<const BoardAdjacency> BoardAdjacency::forSize(int rows, int cols) {
+    static mutex cacheLock;
+    static map<pair<int, int>, shared_ptr<const BoardAdjacency> > cache;
+
+    lock_guard<mutex> lock(cacheLock);
+    shared_ptr<const BoardAdjacency>& table = cache[make_pair(rows, cols)];
+    if (table) return table;
+
+    shared_ptr<BoardAdjacency> built = make_shared<BoardAdjacency>();
+    built->rows = rows;
+    built->cols = cols;
+    for (int row = 0; row < rows; row++) {
+        for (int col = 0; col < cols; col++) {
+            built->start.push_back(built->neighbors.size());
+            for (int r = row - 1; r <= row + 1; r++) {
+                for (int c = col - 1; c <= col + 1; c++) {
+                    // inside the board, and not the cell itself
+                    if ((r != row || c != col) && r >= 0 && r < rows && c >= 0 && c < cols) {
+                        built->neighbors.push_back(r * cols + c);
+                    }
+                }
+            }
+        }
+    }
+    built->start.push_back(built->neighbors.size());
+
+    table = built;
+    return table;
+}
@@ -0,0 +1,64 @@
+//
+//  boggleboard.h
+//
+//  Board geometry shared by the Boggle searches: cells of a rows x cols board are
+//  numbered row * cols + col, their neighbours come from a table built once per
+//  board size, and a set of used cells is a bitmask.
+//
+//  Created by Jian Zhong on 7/22/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#ifndef _boggleboard_h
+#define _boggleboard_h
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+/*
+ * The neighbours of every cell of a board size, in row-major order around the cell.
+ * The neighbours of cell i are neighbors[start[i] .. start[i + 1]).
+ */
+struct BoardAdjacency {
+    int rows;
+    int cols;
+    vector<int> start;      // size rows * cols + 1
+    vector<int> neighbors;
+
+    /*
+     * Get the table of a board size. Tables are built once and shared; this may be
+     * called from several threads.
+     */
+    static shared_ptr<const BoardAdjacency> forSize(int rows, int cols);
+};
+
+/* A set of board cells, one bit per cell */
+class CellSet {
+public:
+    /*
+     * Empty the set and make room for cells 0 .. numCells - 1.
+     */
+    void reset(int numCells) {
+        bits.assign((numCells + 63) / 64, 0);
+    }
+
+    bool contains(int cell) const {
+        return (bits[cell >> 6] >> (cell & 63)) & 1;
+    }
+
+    void add(int cell) {
+        bits[cell >> 6] |= 1ULL << (cell & 63);
+    }
+
+    void remove(int cell) {
+        bits[cell >> 6] &= ~(1ULL << (cell & 63));
+    }
+
+private:
+    vector<uint64_t> bits;
+};
+
+#endif // _boggleboard_h
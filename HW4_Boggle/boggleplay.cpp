@@ -7,6 +7,8 @@
 //  Copyright © 2020 Jian Zhong. All rights reserved.
 
 #include "lexicon.h"   // store dictionary file
+#include "../Shared/compactlexicon.h" // dictionary shared by all games
+#include "filelib.h"   // fileExists()
 #include "simpio.h"    // getYesOrNo();
 #include "bogglegui.h" // BoggleGUI
 #include "Boggle.h"    // Boggle class
@@ -14,8 +16,12 @@
 #include <ctype.h>     // isalpha()
 using namespace std;
 
+// Compiled dictionary (see lexiconcompile) that the games map instead of copying the lexicon.
+const string COMPILED_DICTIONARY_FILE = "EnglishWords.clex";
+
 
 // Function prototypes:
+shared_ptr<const CompactLexicon> sharedDictionary(const Lexicon&);
 void blankBoard();
 string getBoardText();
 void printBoard(const string&);
@@ -37,7 +43,7 @@ void playOneGame(Lexicon& dictionary) {
     string boardText = getBoardText();
 
     // Setup Boggle Board with board text
-    Boggle board(dictionary, boardText);
+    Boggle board(sharedDictionary(dictionary), boardText);
 
     // Setup and print Boggle GUI
     printBoard(boardText);
@@ -51,6 +57,18 @@ void playOneGame(Lexicon& dictionary) {
 
 
 // Function Definitions:
+
+/*
+ * Get the dictionary that every game shares: the compiled dictionary file when there
+ * is one, or else a compact copy of the lexicon. Either is made once per run.
+ */
+shared_ptr<const CompactLexicon> sharedDictionary(const Lexicon& dictionary) {
+    static const shared_ptr<const CompactLexicon> shared = fileExists(COMPILED_DICTIONARY_FILE)
+            ? CompactLexicon::open(COMPILED_DICTIONARY_FILE)
+            : make_shared<const CompactLexicon>(dictionary);
+    return shared;
+}
+
 bool isValidBoardText(string& boardText) {
     boardText = getLine("Type the 16 letters to appear on the board: ");
 
@@ -0,0 +1,241 @@
+//
+//  boggleserver.cpp
+//
+//  Also a load generator: a command-line tool that starts many games and has client
+//  threads check words in them, then reports the checks per second and their latency.
+//  Built on its own (define BOGGLE_SERVER_MAIN) so it does not clash with the game's main.
+//
+//  Created by Jian Zhong on 8/3/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#include "boggleserver.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include "strlib.h"
+
+BoggleServer::Shard::Shard(shared_ptr<const CompactLexicon> dictionary, int rows, int cols)
+    : solver(dictionary, rows, cols) {
+}
+
+BoggleServer::BoggleServer(shared_ptr<const CompactLexicon> dictionary, int rows, int cols, int numShards)
+    : dictionary(dictionary), rows(rows), cols(cols), nextGame(0), gameCount(0) {
+    seed = chrono::steady_clock::now().time_since_epoch().count();
+    for (int i = 0; i < max(1, numShards); i++) {
+        shards.emplace_back(new Shard(dictionary, rows, cols));
+    }
+}
+
+BoggleServer::Shard& BoggleServer::shardOf(int game) {
+    if (game < 0) throw "The game does not exist.";
+    return *shards[game % shards.size()];
+}
+
+int BoggleServer::newGame(string boardText) {
+    int id = nextGame++;
+    if (boardText.empty()) {
+        boardText = randomBoard(rows, cols, seed, id);
+    } else if ((int) boardText.length() != rows * cols) {
+        throw "The board text does not fit the board size.";
+    }
+
+    ServerGame game;
+    game.board = toUpperCase(boardText);
+    Shard& shard = shardOf(id);
+
+    // solve the board once; every check is then a lookup
+    Vector<string> words;
+    {
+        lock_guard<mutex> lock(shard.solverLock);
+        shard.solver.solve(game.board, &words);
+    }
+    for (const string& word : words) {
+        game.answers.add(word);
+    }
+
+    lock_guard<mutex> lock(shard.gamesLock);
+    shard.games.put(id, game);
+    gameCount++;
+    return id;
+}
+
+WordCheckT BoggleServer::checkWord(int game, const string& word) {
+    if (game < 0) return NoSuchGame;
+    string upper = toUpperCase(word);  // case-insensitive
+    Shard& shard = shardOf(game);
+    {
+        lock_guard<mutex> lock(shard.gamesLock);
+        if (!shard.games.containsKey(game)) return NoSuchGame;
+
+        ServerGame& playing = shard.games[game];
+        if (playing.answers.contains(upper)) {
+            if (playing.wordsHuman.contains(upper)) return AlreadyFound;
+            playing.wordsHuman.add(upper);
+            playing.scoreHuman += upper.length() - 3;
+            return NewWord;
+        }
+    }
+
+    // not on the board; tell a word that is not one from a word that cannot be formed
+    if ((int) upper.length() < MIN_WORD_LENGTH || !dictionary->contains(upper)) return NotAWord;
+    return NotOnBoard;
+}
+
+string BoggleServer::getBoard(int game) {
+    Shard& shard = shardOf(game);
+    lock_guard<mutex> lock(shard.gamesLock);
+    if (!shard.games.containsKey(game)) throw "The game does not exist.";
+    return shard.games[game].board;
+}
+
+int BoggleServer::getScoreHuman(int game) {
+    Shard& shard = shardOf(game);
+    lock_guard<mutex> lock(shard.gamesLock);
+    if (!shard.games.containsKey(game)) throw "The game does not exist.";
+    return shard.games[game].scoreHuman;
+}
+
+Set<string> BoggleServer::getWordsHuman(int game) {
+    Shard& shard = shardOf(game);
+    lock_guard<mutex> lock(shard.gamesLock);
+    if (!shard.games.containsKey(game)) throw "The game does not exist.";
+    return shard.games[game].wordsHuman;
+}
+
+Set<string> BoggleServer::endGame(int game) {
+    Shard& shard = shardOf(game);
+    ServerGame ended;
+    {
+        lock_guard<mutex> lock(shard.gamesLock);
+        if (!shard.games.containsKey(game)) throw "The game does not exist.";
+        ended = shard.games[game];
+        shard.games.remove(game);
+        gameCount--;
+    }
+
+    // the computer does not get the words the human found already
+    Set<string> wordsComputer;
+    for (const string& word : ended.answers) {
+        if (!ended.wordsHuman.contains(word)) wordsComputer.add(word);
+    }
+    return wordsComputer;
+}
+
+int BoggleServer::numGames() const {
+    return gameCount;
+}
+
+#ifdef BOGGLE_SERVER_MAIN
+/*
+ * Usage: boggleserver DICTIONARY [-games N] [-clients N] [-checks N] [-seed N]
+ * Each of the clients checks words in random games; most of the words are on the
+ * game's board, the rest are random dictionary words.
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "usage: " << argv[0] << " DICTIONARY [-games N] [-clients N] [-checks N] [-seed N]" << endl;
+        return 1;
+    }
+
+    int numGames = 10000, numClients = 0, numChecks = 1000000;
+    unsigned long long seed = 1;
+    for (int i = 2; i < argc; i++) {
+        string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "-games" && hasValue) {
+            numGames = atoi(argv[++i]);
+        } else if (option == "-clients" && hasValue) {
+            numClients = atoi(argv[++i]);
+        } else if (option == "-checks" && hasValue) {
+            numChecks = atoi(argv[++i]);
+        } else if (option == "-seed" && hasValue) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else {
+            cerr << "unknown option " << option << endl;
+            return 1;
+        }
+    }
+    if (numGames <= 0) {
+        cerr << "there must be at least one game" << endl;
+        return 1;
+    }
+    if (numClients <= 0) numClients = max(1, (int) thread::hardware_concurrency());
+
+    shared_ptr<const CompactLexicon> dictionary = CompactLexicon::open(argv[1]);
+    BoggleServer server(dictionary);
+
+    // start the games; the clients get to know their answers on the side
+    Vector<string> boards;
+    for (int i = 0; i < numGames; i++) {
+        boards.add(randomBoard(4, 4, seed, i));
+    }
+    auto startTime = chrono::steady_clock::now();
+    std::vector<int> ids;
+    for (const string& board : boards) {
+        ids.push_back(server.newGame(board));
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    cout << numGames << " games started in " << seconds << " s (" << numGames / seconds << " games/s)" << endl;
+    Vector<BoggleResult> answers = solveBoards(dictionary, boards, 4, 4, true);
+
+    // every client sends its checks one after another and times each of them
+    int checksPerClient = max(1, numChecks / numClients);
+    std::vector<std::vector<long long> > latencies(numClients);
+    std::vector<std::vector<long long> > outcomes(numClients, std::vector<long long>(NoSuchGame + 1, 0));
+    auto client = [&](int c) {
+        uint64_t state = seed ^ ((c + 1) * 0xd1b54a32d192ed03ULL);
+        nextRandom(state); // scramble the start state
+        latencies[c].resize(checksPerClient);
+        for (int k = 0; k < checksPerClient; k++) {
+            int game = nextRandom(state) % numGames;
+            const Vector<string>& words = answers[game].words;
+            string word = nextRandom(state) % 4 != 0 && !words.isEmpty()
+                ? words[nextRandom(state) % words.size()]
+                : dictionary->wordAt(nextRandom(state) % dictionary->size());
+
+            auto sent = chrono::steady_clock::now();
+            WordCheckT outcome = server.checkWord(ids[game], word);
+            latencies[c][k] = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - sent).count();
+            outcomes[c][outcome]++;
+        }
+    };
+
+    startTime = chrono::steady_clock::now();
+    std::vector<thread> clients;
+    for (int c = 0; c < numClients; c++) {
+        clients.emplace_back(client, c);
+    }
+    for (thread& t : clients) {
+        t.join();
+    }
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+    // the latency at the 50th and 99th percentiles, over all clients
+    std::vector<long long> all;
+    long long counts[NoSuchGame + 1] = {0};
+    for (int c = 0; c < numClients; c++) {
+        all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+        for (int outcome = 0; outcome <= NoSuchGame; outcome++) {
+            counts[outcome] += outcomes[c][outcome];
+        }
+    }
+    sort(all.begin(), all.end());
+    long long total = all.size();
+    cout << total << " checks from " << numClients << " clients in " << seconds << " s ("
+         << total / seconds << " checks/s)" << endl;
+    cout << "latency p50 " << all[total / 2] / 1000.0 << " us, p99 " << all[total * 99 / 100] / 1000.0
+         << " us, max " << all.back() / 1000.0 << " us" << endl;
+    cout << counts[NewWord] << " new, " << counts[AlreadyFound] << " already found, "
+         << counts[NotAWord] << " not words, " << counts[NotOnBoard] << " not on the board" << endl;
+
+    long long computerWords = 0;
+    for (int id : ids) {
+        computerWords += server.endGame(id).size();
+    }
+    cout << "games ended, " << computerWords << " words left to the computer" << endl;
+    return 0;
+}
+#endif // BOGGLE_SERVER_MAIN
@@ -0,0 +1,110 @@
+//
+//  boggleserver.h
+//
+//  Hosts many Boggle games at once in one process. Every game is solved when it
+//  starts, so checking a player's word is a lookup in the game's answers instead of a
+//  search of its board. The games share one read-only dictionary and are spread over
+//  shards, each with its own lock, so that threads serving different games seldom wait
+//  on each other.
+//
+//  Created by Jian Zhong on 8/3/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#ifndef _boggleserver_h
+#define _boggleserver_h
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "bogglesolver.h"
+#include "../Shared/compactlexicon.h"
+#include "hashmap.h"
+#include "hashset.h"
+#include "set.h"
+
+using namespace std;
+
+// What checkWord made of a word.
+enum WordCheckT {NewWord, AlreadyFound, NotAWord, NotOnBoard, NoSuchGame};
+
+class BoggleServer {
+public:
+    /*
+     * Construct a server for rows x cols games over a shared dictionary, with its games
+     * spread over numShards locks.
+     */
+    BoggleServer(shared_ptr<const CompactLexicon> dictionary, int rows = 4, int cols = 4, int numShards = 64);
+
+    /*
+     * Start a game on boardText, row by row, or on a random board if it is empty, and
+     * return the game's id.
+     */
+    int newGame(string boardText = "");
+
+    /*
+     * Check a word the human player typed in a game, and record it if it is new: a word
+     * of 4+ letters from the dictionary that can be formed on the board.
+     */
+    WordCheckT checkWord(int game, const string& word);
+
+    /*
+     * Get the board of a game, row by row.
+     */
+    string getBoard(int game);
+
+    /*
+     * Get the human player's score in a game.
+     */
+    int getScoreHuman(int game);
+
+    /*
+     * Get the words the human player found in a game.
+     */
+    Set<string> getWordsHuman(int game);
+
+    /*
+     * End a game and return the computer's words: those on the board the human did
+     * not find.
+     */
+    Set<string> endGame(int game);
+
+    /*
+     * Get the number of games being played.
+     */
+    int numGames() const;
+
+private:
+    /* One game */
+    struct ServerGame {
+        string board;
+        HashSet<string> answers;    // every word on the board, upper case
+        Set<string> wordsHuman;     // words the human found
+        int scoreHuman = 0;
+    };
+
+    /* Some of the games, with the locks that guard them */
+    struct Shard {
+        mutex gamesLock;
+        HashMap<int, ServerGame> games;
+        mutex solverLock;           // solving a new board does not hold up the checks
+        BoggleSolver solver;
+
+        Shard(shared_ptr<const CompactLexicon> dictionary, int rows, int cols);
+    };
+
+    Shard& shardOf(int game);
+
+    shared_ptr<const CompactLexicon> dictionary;
+    int rows;
+    int cols;
+    uint64_t seed;                  // of the random boards
+    vector<unique_ptr<Shard> > shards;
+    atomic<int> nextGame;
+    atomic<int> gameCount;
+};
+
+#endif // _boggleserver_h
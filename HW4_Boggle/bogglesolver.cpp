@@ -0,0 +1,368 @@
+//
+//  bogglesolver.cpp
+//
+//  Created by Jian Zhong on 7/24/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#include "bogglesolver.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include "strlib.h"
+
+// letters on all 6 sides of every cube
+const string CUBES[16] = {
+    "AAEEGN", "ABBJOO", "ACHOPS", "AFFKPS",
+    "AOOTTW", "CIMOTU", "DEILRX", "DELRVY",
+    "DISTTY", "EEGHNW", "EEINSU", "EHRTVW",
+    "EIOSST", "ELRTTY", "HIMNQU", "HLNNRZ"
+};
+
+// Number of boards a solveBoards worker claims at a time.
+const int SOLVE_CHUNK = 256;
+
+// Number of gone paths changeCell keeps on top of the live ones before dropping them.
+const int PATH_SLACK = 1024;
+
+BoggleSolver::BoggleSolver(shared_ptr<const CompactLexicon> dictionary, int rows, int cols)
+    : dictionary(dictionary) {
+    adjacency = BoardAdjacency::forSize(rows, cols);
+    used.reset(rows * cols);
+    foundStamp.assign(dictionary->size(), 0);
+    stamp = 0;
+    score = 0;
+    wordCount = 0;
+    board = nullptr;
+    keepWords = false;
+    changed = -1;
+    livePaths = 0;
+}
+
+int BoggleSolver::solve(const string& board, Vector<string>* words) {
+    int numCells = adjacency->rows * adjacency->cols;
+    if ((int) board.length() != numCells) throw "The board text does not fit the board size.";
+
+    // a new stamp forgets the words of the last board
+    if (++stamp == 0) {
+        foundStamp.assign(foundStamp.size(), 0);
+        stamp = 1;
+    }
+    this->board = &board;
+    keepWords = words != nullptr;
+    found.clear();
+    score = 0;
+    wordCount = 0;
+
+    for (int cell = 0; cell < numCells; cell++) {
+        stats.prefixLookups++;
+        int node = dictionary->child(CompactLexicon::ROOT, board[cell]);
+        if (node < 0) continue;    // no word starts with this letter
+
+        formed += toupper(board[cell]);
+        used.add(cell);
+        search(cell, node, dictionary->childNumber(CompactLexicon::ROOT, 0, node));
+        used.remove(cell);
+        formed.pop_back();
+    }
+
+    if (keepWords) {
+        sort(found.begin(), found.end());
+        for (const string& word : found) {
+            words->add(word);
+        }
+    }
+    return score;
+}
+
+void BoggleSolver::search(int cell, int node, int number) {
+    stats.nodesVisited++;
+
+    // a word of 4+ letters, counted the first time any path reaches it; words share
+    // nodes in the dictionary, so they are told apart by number
+    if (dictionary->isWord(node) && (int) formed.length() >= MIN_WORD_LENGTH && foundStamp[number] != stamp) {
+        foundStamp[number] = stamp;
+        score += formed.length() - 3;
+        wordCount++;
+        if (keepWords) found.push_back(formed);
+    }
+
+    for (int i = adjacency->start[cell]; i < adjacency->start[cell + 1]; i++) {
+        int neighbor = adjacency->neighbors[i];
+        if (used.contains(neighbor)) continue;
+
+        // one step down the dictionary
+        stats.prefixLookups++;
+        int next = dictionary->child(node, (*board)[neighbor]);
+        if (next < 0) continue;
+
+        used.add(neighbor);
+        formed += toupper((*board)[neighbor]);
+        search(neighbor, next, dictionary->childNumber(node, number, next));
+        formed.pop_back();
+        used.remove(neighbor);
+    }
+}
+
+int BoggleSolver::solveIncremental(const string& board) {
+    int numCells = adjacency->rows * adjacency->cols;
+    if ((int) board.length() != numCells) throw "The board text does not fit the board size.";
+
+    current = toUpperCase(board);
+    pathCount.assign(dictionary->size(), 0);
+    paths.clear();
+    cellPaths.assign(numCells, vector<int>());
+    livePaths = 0;
+    pathCells.resize(numCells);
+    score = 0;
+    wordCount = 0;
+
+    for (int cell = 0; cell < numCells; cell++) {
+        stats.prefixLookups++;
+        int node = dictionary->child(CompactLexicon::ROOT, current[cell]);
+        if (node < 0) continue;    // no word starts with this letter
+
+        used.add(cell);
+        countPaths(cell, node, dictionary->childNumber(CompactLexicon::ROOT, 0, node), 1);
+        used.remove(cell);
+    }
+    return score;
+}
+
+int BoggleSolver::changeCell(int cell, char letter) {
+    if (cell < 0 || cell >= (int) current.length()) throw "The cell is not on the board.";
+    letter = toupper(letter);
+    if (current[cell] == letter) return score;
+
+    // the paths through the cell are gone; the rest stay as they are
+    removePaths(cell);
+    current[cell] = letter;
+    changed = cell;
+
+    // a path must still take this many steps to reach the changed cell
+    int cols = adjacency->cols;
+    distance.resize(current.length());
+    for (int other = 0; other < (int) current.length(); other++) {
+        distance[other] = max(abs(other / cols - cell / cols), abs(other % cols - cell % cols));
+    }
+
+    // find the new paths through it
+    for (int start = 0; start < (int) current.length(); start++) {
+        if (start == cell) {
+            reachChanged(CompactLexicon::ROOT, 0, 0);
+            continue;
+        }
+        stats.prefixLookups++;
+        int node = dictionary->child(CompactLexicon::ROOT, current[start]);
+        if (node < 0) continue;    // no word starts with this letter
+
+        used.add(start);
+        pathCells[0] = start;
+        searchToward(start, node, dictionary->childNumber(CompactLexicon::ROOT, 0, node), 1);
+        used.remove(start);
+    }
+    return score;
+}
+
+void BoggleSolver::searchToward(int cell, int node, int number, int length) {
+    stats.nodesVisited++;
+
+    // no word below node is long enough to reach the changed cell
+    int height = dictionary->height(node);
+    if (height < CompactLexicon::MAX_HEIGHT && distance[cell] > height) return;
+
+    for (int i = adjacency->start[cell]; i < adjacency->start[cell + 1]; i++) {
+        int neighbor = adjacency->neighbors[i];
+        if (used.contains(neighbor)) continue;
+        if (neighbor == changed) {
+            reachChanged(node, number, length);
+            continue;
+        }
+
+        stats.prefixLookups++;
+        int next = dictionary->child(node, current[neighbor]);
+        if (next < 0) continue;
+
+        used.add(neighbor);
+        pathCells[length] = neighbor;
+        searchToward(neighbor, next, dictionary->childNumber(node, number, next), length + 1);
+        used.remove(neighbor);
+    }
+}
+
+void BoggleSolver::reachChanged(int node, int number, int length) {
+    stats.prefixLookups++;
+    int next = dictionary->child(node, current[changed]);
+    if (next < 0) return;
+
+    used.add(changed);
+    countPaths(changed, next, dictionary->childNumber(node, number, next), length + 1);
+    used.remove(changed);
+}
+
+void BoggleSolver::countPaths(int cell, int node, int number, int length) {
+    stats.nodesVisited++;
+
+    pathCells[length - 1] = cell;
+    if (length >= MIN_WORD_LENGTH && dictionary->isWord(node)) {
+        addPath(number, length);
+    }
+
+    for (int i = adjacency->start[cell]; i < adjacency->start[cell + 1]; i++) {
+        int neighbor = adjacency->neighbors[i];
+        if (used.contains(neighbor)) continue;
+
+        stats.prefixLookups++;
+        int next = dictionary->child(node, current[neighbor]);
+        if (next < 0) continue;
+
+        used.add(neighbor);
+        countPaths(neighbor, next, dictionary->childNumber(node, number, next), length + 1);
+        used.remove(neighbor);
+    }
+}
+
+void BoggleSolver::addPath(int number, int length) {
+    int id = paths.size();
+    paths.push_back({number, length});
+    for (int i = 0; i < length; i++) {
+        cellPaths[pathCells[i]].push_back(id);
+    }
+    livePaths++;
+
+    if (pathCount[number]++ == 0) {
+        score += length - 3;
+        wordCount++;
+    }
+}
+
+void BoggleSolver::removePaths(int cell) {
+    for (int id : cellPaths[cell]) {
+        FoundPath& path = paths[id];
+        if (path.number < 0) continue;  // already gone
+
+        if (--pathCount[path.number] == 0) {
+            score -= path.length - 3;
+            wordCount--;
+        }
+        path.number = -1;
+        livePaths--;
+    }
+    cellPaths[cell].clear();
+
+    if ((int) paths.size() > 2 * livePaths + PATH_SLACK) {
+        compactPaths();
+    }
+}
+
+void BoggleSolver::compactPaths() {
+    vector<int> newId(paths.size(), -1);
+    int live = 0;
+    for (int id = 0; id < (int) paths.size(); id++) {
+        if (paths[id].number < 0) continue;
+        newId[id] = live;
+        paths[live++] = paths[id];
+    }
+    paths.resize(live);
+
+    for (vector<int>& ids : cellPaths) {
+        int kept = 0;
+        for (int id : ids) {
+            if (newId[id] >= 0) ids[kept++] = newId[id];
+        }
+        ids.resize(kept);
+    }
+}
+
+const string& BoggleSolver::getBoard() const {
+    return current;
+}
+
+void BoggleSolver::getWords(Vector<string>& words) const {
+    for (int number = 0; number < (int) pathCount.size(); number++) {
+        if (pathCount[number] > 0) words.add(toUpperCase(dictionary->wordAt(number)));
+    }
+}
+
+const SolveStats& BoggleSolver::getStats() const {
+    return stats;
+}
+
+void BoggleSolver::resetStats() {
+    stats = SolveStats();
+}
+
+int BoggleSolver::getWordCount() const {
+    return wordCount;
+}
+
+Vector<BoggleResult> solveBoards(shared_ptr<const CompactLexicon> dictionary, const Vector<string>& boards,
+                                 int rows, int cols, bool keepWords, int numThreads) {
+    int count = boards.size();
+    Vector<BoggleResult> results(count);
+
+    if (numThreads <= 0) numThreads = max(1, (int) thread::hardware_concurrency());
+    numThreads = max(1, min(numThreads, (count + SOLVE_CHUNK - 1) / SOLVE_CHUNK));
+
+    atomic<int> nextChunk(0);
+    mutex failureLock;
+    exception_ptr failure; // the first error thrown by any worker
+    auto worker = [&]() {
+        try {
+            BoggleSolver solver(dictionary, rows, cols);
+            for (;;) {
+                int first = nextChunk.fetch_add(SOLVE_CHUNK);
+                if (first >= count) break;
+                for (int i = first; i < min(first + SOLVE_CHUNK, count); i++) {
+                    BoggleResult& result = results[i];
+                    result.score = solver.solve(boards[i], keepWords ? &result.words : nullptr);
+                    result.wordCount = solver.getWordCount();
+                }
+            }
+        } catch (...) {
+            // keep the error for the caller, and stop the other workers
+            lock_guard<mutex> lock(failureLock);
+            if (!failure) failure = current_exception();
+            nextChunk = count;
+        }
+    };
+
+    std::vector<thread> workers;
+    for (int t = 1; t < numThreads; t++) {
+        workers.emplace_back(worker);
+    }
+    worker(); // the calling thread takes a share too
+    for (thread& t : workers) {
+        t.join();
+    }
+
+    if (failure) rethrow_exception(failure);
+    return results;
+}
+
+uint64_t nextRandom(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+string randomBoard(int rows, int cols, uint64_t seed, uint64_t index) {
+    uint64_t state = seed ^ (index * 0xd1b54a32d192ed03ULL);
+    nextRandom(state); // scramble the start state
+
+    int order[16];
+    string board;
+    for (int pos = 0; pos < rows * cols; pos++) {
+        if (pos % 16 == 0) {
+            // shuffle the 16 cube locations (Fisher-Yates)
+            for (int i = 0; i < 16; i++) order[i] = i;
+            for (int i = 15; i > 0; i--) swap(order[i], order[nextRandom(state) % (i + 1)]);
+        }
+        board += CUBES[order[pos % 16]][nextRandom(state) % 6];
+    }
+    return board;
+}
@@ -0,0 +1,169 @@
+//
+//  bogglesolver.h
+//
+//  Finds every word on a Boggle board without the GUI, so that many boards can be
+//  solved one after another or in parallel against one shared, read-only dictionary.
+//
+//  Created by Jian Zhong on 7/24/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#ifndef _bogglesolver_h
+#define _bogglesolver_h
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "boggleboard.h"
+#include "../Shared/compactlexicon.h"
+#include "vector.h"
+
+using namespace std;
+
+// Shortest word that counts; a word scores one point per letter past 3.
+const int MIN_WORD_LENGTH = 4;
+
+// letters on all 6 sides of every cube
+extern const string CUBES[16];
+
+/* The words on one board */
+struct BoggleResult {
+    int score = 0;
+    int wordCount = 0;
+    Vector<string> words;   // sorted; left empty when the words are not kept
+};
+
+/* Work done by a solver since it was made or its counts were reset */
+struct SolveStats {
+    long long nodesVisited = 0;     // cells the search stepped onto
+    long long prefixLookups = 0;    // dictionary steps tried
+};
+
+class BoggleSolver {
+public:
+    /*
+     * Construct a solver for rows x cols boards.
+     */
+    BoggleSolver(shared_ptr<const CompactLexicon> dictionary, int rows = 4, int cols = 4);
+
+    /*
+     * Find the words on a board of rows * cols letters, given row by row in either case.
+     * Return the total score; if words is not null, the words found are added to it in
+     * upper case and sorted order.
+     */
+    int solve(const string& board, Vector<string>* words = nullptr);
+
+    /*
+     * Solve a board like solve() and keep it, with every path that spells a word and
+     * the paths through each cell, so that changeCell can bring the result up to date
+     * after a cube changes.
+     */
+    int solveIncremental(const string& board);
+
+    /*
+     * Change the letter of one cell of the board kept by solveIncremental and return
+     * the new score. The kept paths through the cell are taken off, and only the paths
+     * that can reach the cell are searched again for new ones.
+     */
+    int changeCell(int cell, char letter);
+
+    /*
+     * Get the board kept by solveIncremental, with every change since.
+     */
+    const string& getBoard() const;
+
+    /*
+     * Add the words of the board kept by solveIncremental to words, in sorted order.
+     * This looks through the whole dictionary, so it is slow next to changeCell.
+     */
+    void getWords(Vector<string>& words) const;
+
+    /*
+     * Get the number of words found by the last solve(), or on the kept board.
+     */
+    int getWordCount() const;
+
+    /*
+     * Get the work done so far, or start counting again.
+     */
+    const SolveStats& getStats() const;
+    void resetStats();
+
+private:
+    /*
+     * Helper for solve(): formed ends on cell, node is its dictionary node and number
+     * its number in the dictionary.
+     */
+    void search(int cell, int node, int number);
+
+    /*
+     * Helpers for solveIncremental() and changeCell(): find the paths that go on from a
+     * path of length letters ending on cell, or that go on to the changed cell, and keep
+     * the ones spelling words.
+     */
+    void countPaths(int cell, int node, int number, int length);
+    void searchToward(int cell, int node, int number, int length);
+    void reachChanged(int node, int number, int length);
+
+    /*
+     * Keep the path in pathCells as spelling a word; a word is on the board while at
+     * least one path spells it. Paths taken off a cell stay listed under their other
+     * cells, marked as gone, until there are more gone paths than live ones; then
+     * compactPaths() drops them and renumbers the live ones.
+     */
+    void addPath(int number, int length);
+    void removePaths(int cell);
+    void compactPaths();
+
+    /* A path spelling a word on the kept board */
+    struct FoundPath {
+        int number;             // the word's number, or -1 once the path is gone
+        int length;
+    };
+
+    shared_ptr<const CompactLexicon> dictionary;
+    shared_ptr<const BoardAdjacency> adjacency;
+    const string* board;       // the board being solved
+    vector<string> found;      // words of the board being solved, if wanted
+    bool keepWords;
+    string formed;             // letters of the current path
+    CellSet used;              // cells of the current path
+    vector<int> foundStamp;    // word number -> stamp of the last board it was found on
+    int stamp;
+    int score;
+    int wordCount;
+    SolveStats stats;
+
+    // kept by solveIncremental
+    string current;            // the board, with every change since
+    vector<int> pathCount;     // word number -> paths spelling it on current (4+ letters only)
+    vector<FoundPath> paths;   // paths spelling words, by id
+    vector<vector<int> > cellPaths; // cell -> ids of the paths through it, some of them gone
+    int livePaths;
+    vector<int> pathCells;     // cells of the current path, in order
+    vector<int> distance;      // cell -> steps from the changed cell
+    int changed;               // the cell being changed
+};
+
+/*
+ * Solves boards on numThreads threads (0 means one per core), each thread with its
+ * own solver over the shared dictionary. Result i belongs to boards[i]. If solving a
+ * board throws, the rest are given up and the first error is thrown again here.
+ */
+Vector<BoggleResult> solveBoards(shared_ptr<const CompactLexicon> dictionary, const Vector<string>& boards,
+                                 int rows, int cols, bool keepWords, int numThreads = 0);
+
+/*
+ * Return a random rows x cols board rolled from CUBES, which are reshuffled for every
+ * 16 cells. The board depends only on seed and index, so boards can be generated in
+ * any order or on any thread.
+ */
+string randomBoard(int rows, int cols, uint64_t seed, uint64_t index);
+
+/*
+ * Return the next value of a splitmix64 stream, advancing its state.
+ */
+uint64_t nextRandom(uint64_t& state);
+
+#endif // _bogglesolver_h
@@ -0,0 +1,37 @@
+//
+//  lexiconcompile.cpp
+//
+//  Command-line tool that compiles a word list into a dictionary file, which Boggle,
+//  bogglebatch and the word ladder open by mapping it instead of rebuilding the trie.
+//  Built on its own (define LEXICON_COMPILE_MAIN) so it does not clash with the game's main.
+//
+//  Created by Jian Zhong on 7/27/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "../Shared/compactlexicon.h"
+
+using namespace std;
+
+#ifdef LEXICON_COMPILE_MAIN
+/*
+ * Usage: lexiconcompile WORDLIST OUTPUT
+ */
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        cerr << "usage: " << argv[0] << " WORDLIST OUTPUT" << endl;
+        return 1;
+    }
+
+    shared_ptr<const CompactLexicon> dictionary = CompactLexicon::open(argv[1]);
+    dictionary->save(argv[2]);
+    ifstream output(argv[2], ios::binary | ios::ate);
+    cout << dictionary->size() << " words, " << dictionary->numNodes() << " nodes, "
+         << output.tellg() << " bytes" << endl;
+    return 0;
+}
+#endif // LEXICON_COMPILE_MAIN
@@ -0,0 +1,299 @@
+// ConcurrentPatientQueue.cpp
+//
+// Also a load test: producer threads admit patients while consumer threads process
+// them, once with a single heap (a global lock) and once with many, and every patient
+// must be processed exactly once. Built on its own (define CONCURRENT_PATIENT_QUEUE_MAIN)
+// so it does not clash with the assignment's main.
+
+#include "ConcurrentPatientQueue.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include "hashset.h"
+
+ConcurrentPatientQueue::SubQueue::SubQueue() : front(EMPTY_FRONT), count(0) {
+}
+
+
+void ConcurrentPatientQueue::SubQueue::updateFront() {
+    front = queue.isEmpty() ? EMPTY_FRONT : queue.frontPriority();
+}
+
+
+ConcurrentPatientQueue::ConcurrentPatientQueue(int numQueues) : size(0) {
+    if (numQueues <= 0) {
+        numQueues = 2 * max(1, (int) thread::hardware_concurrency());
+    }
+    for (int i = 0; i < numQueues; i++) {
+        queues.emplace_back(new SubQueue());
+    }
+}
+
+
+ConcurrentPatientQueue::~ConcurrentPatientQueue() {
+}
+
+
+void ConcurrentPatientQueue::clear() {
+    for (auto& sub : queues) {
+        lock_guard<mutex> lock(sub->lock);
+        sub->queue.clear();
+        size -= sub->count;
+        sub->count = 0;
+        sub->updateFront();
+    }
+}
+
+
+string ConcurrentPatientQueue::frontName() {
+    while (true) {
+        int best = mostUrgentQueue();
+        if (best == -1) {
+            error("Attempting to return front name in an EMPTY queue.");
+        }
+
+        SubQueue& sub = *queues[best];
+        lock_guard<mutex> lock(sub.lock);
+        if (!sub.queue.isEmpty()) return sub.queue.frontName();
+        // emptied by another thread since we looked; look again
+    }
+}
+
+
+int ConcurrentPatientQueue::frontPriority() {
+    while (true) {
+        int best = mostUrgentQueue();
+        if (best == -1) {
+            error("Attempting to return front priority in an EMPTY queue.");
+        }
+
+        long long front = queues[best]->front;
+        if (front != EMPTY_FRONT) return front;
+    }
+}
+
+
+bool ConcurrentPatientQueue::isEmpty() {
+    return size == 0;
+}
+
+
+// log n
+void ConcurrentPatientQueue::newPatient(string name, int priority) {
+    // take the first random heap whose lock is free; after a try at every heap, wait
+    for (int attempt = 0; ; attempt++) {
+        SubQueue& sub = *queues[randomQueue()];
+        unique_lock<mutex> lock(sub.lock, defer_lock);
+        if (attempt < (int) queues.size()) {
+            if (!lock.try_lock()) continue;
+        } else {
+            lock.lock();
+        }
+
+        sub.queue.newPatient(name, priority);
+        sub.count++;
+        sub.updateFront();
+        size++;
+        return;
+    }
+}
+
+
+// log n
+string ConcurrentPatientQueue::processPatient() {
+    string name;
+    if (!tryProcessPatient(name)) {
+        error("Processing patient in an EMPTY queue.");
+    }
+    return name;
+}
+
+
+// log n
+bool ConcurrentPatientQueue::tryProcessPatient(string& name) {
+    while (size > 0) {
+        // the more urgent front of two random heaps, or of all heaps if both are empty
+        int a = randomQueue();
+        int b = randomQueue();
+        int chosen = queues[b]->front < queues[a]->front ? b : a;
+        if (queues[chosen]->front == EMPTY_FRONT) {
+            chosen = mostUrgentQueue();
+            if (chosen == -1) {
+                this_thread::yield(); // a patient is on its way in or out
+                continue;
+            }
+        }
+
+        SubQueue& sub = *queues[chosen];
+        lock_guard<mutex> lock(sub.lock);
+        if (sub.queue.isEmpty()) continue; // emptied by another thread since we looked
+
+        name = sub.queue.processPatient();
+        sub.count--;
+        sub.updateFront();
+        size--;
+        return true;
+    }
+    return false;
+}
+
+
+// numQueues + log n
+void ConcurrentPatientQueue::upgradePatient(string name, int newPriority) {
+    if (isEmpty()) {
+        error("Upgrading patient in an EMPTY queue.");
+    }
+
+    // patients never move between heaps, so look through one heap at a time
+    bool found = false;
+    for (auto& sub : queues) {
+        lock_guard<mutex> lock(sub->lock);
+        if (!sub->queue.contains(name)) continue;
+
+        found = true;
+        if (sub->queue.priorityOf(name) <= newPriority) continue;
+        sub->queue.upgradePatient(name, newPriority);
+        sub->updateFront();
+        return;
+    }
+
+    if (!found) {
+        // if no such patient name, throw exception
+        error("No such patient name in the queue.");
+    }
+    // if existing priority is already more urgent, throw exception
+    error("The existing priority is already more urgent.");
+}
+
+
+// Not a snapshot while other threads change the queue: each heap is read in turn.
+string ConcurrentPatientQueue::toString() {
+    string output = "";
+    for (auto& sub : queues) {
+        lock_guard<mutex> lock(sub->lock);
+        string part = sub->queue.toString();
+        part = part.substr(1, part.length() - 2); // without the braces
+        if (part.empty()) continue;
+        if (!output.empty()) output += ", ";
+        output += part;
+    }
+    return "{" + output + "}";
+}
+
+
+int ConcurrentPatientQueue::numQueues() const {
+    return queues.size();
+}
+
+
+int ConcurrentPatientQueue::randomQueue() const {
+    // xorshift64, seeded once per thread
+    thread_local uint64_t state = hash<thread::id>()(this_thread::get_id()) * 0x9e3779b97f4a7c15ULL | 1;
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state % queues.size();
+}
+
+
+int ConcurrentPatientQueue::mostUrgentQueue() const {
+    int best = -1;
+    long long bestFront = EMPTY_FRONT;
+    for (int i = 0; i < (int) queues.size(); i++) {
+        long long front = queues[i]->front;
+        if (front < bestFront) {
+            best = i;
+            bestFront = front;
+        }
+    }
+    return best;
+}
+
+#ifdef CONCURRENT_PATIENT_QUEUE_MAIN
+// Admit and process numPatients patients on numThreads threads, half producers and
+// half consumers, and return the time it took; throws if a patient went missing.
+double runLoad(ConcurrentPatientQueue& queue, int numPatients, int numThreads) {
+    int numProducers = max(1, numThreads / 2);
+    int numConsumers = max(1, numThreads - numProducers);
+    atomic<int> processed(0);
+    std::vector<Vector<string> > names(numConsumers);
+
+    auto producer = [&](int p) {
+        uint64_t state = (p + 1) * 0x9e3779b97f4a7c15ULL;
+        for (int i = p; i < numPatients; i += numProducers) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            queue.newPatient("Patient" + integerToString(i), state % numPatients + 1);
+        }
+    };
+    auto consumer = [&](int c) {
+        string name;
+        while (processed < numPatients) {
+            if (queue.tryProcessPatient(name)) {
+                names[c].add(name);
+                processed++;
+            } else {
+                this_thread::yield();
+            }
+        }
+    };
+
+    auto startTime = chrono::steady_clock::now();
+    std::vector<thread> threads;
+    for (int p = 0; p < numProducers; p++) {
+        threads.emplace_back(producer, p);
+    }
+    for (int c = 0; c < numConsumers; c++) {
+        threads.emplace_back(consumer, c);
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+    HashSet<string> seen;
+    for (const Vector<string>& consumed : names) {
+        for (const string& name : consumed) {
+            seen.add(name);
+        }
+    }
+    if (seen.size() != numPatients || processed != numPatients || !queue.isEmpty()) {
+        error("Some patients were lost or processed twice.");
+    }
+    return seconds;
+}
+
+/*
+ * Usage: concurrentpatientqueue [-patients N] [-threads N] [-queues N]
+ */
+int main(int argc, char** argv) {
+    int numPatients = 1000000, numThreads = 0, numQueues = 0;
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "-patients" && hasValue) {
+            numPatients = atoi(argv[++i]);
+        } else if (option == "-threads" && hasValue) {
+            numThreads = atoi(argv[++i]);
+        } else if (option == "-queues" && hasValue) {
+            numQueues = atoi(argv[++i]);
+        } else {
+            cerr << "unknown option " << option << endl;
+            return 1;
+        }
+    }
+    if (numThreads <= 0) numThreads = max(2, (int) thread::hardware_concurrency());
+
+    ConcurrentPatientQueue strict(1);
+    ConcurrentPatientQueue relaxed(numQueues);
+    for (ConcurrentPatientQueue* queue : {&strict, &relaxed}) {
+        double seconds = runLoad(*queue, numPatients, numThreads);
+        cout << queue->numQueues() << " heaps, " << numThreads << " threads: " << numPatients
+             << " patients in " << seconds << " s (" << 2 * numPatients / seconds << " operations/s)" << endl;
+    }
+    return 0;
+}
+#endif // CONCURRENT_PATIENT_QUEUE_MAIN
@@ -0,0 +1,87 @@
+﻿// ConcurrentPatientQueue.h
+//
+// A patient queue that many threads can add to and process from at once. It is a
+// MultiQueue: the patients are spread over numQueues HeapPatientQueues, each with its
+// own lock. A new patient goes into a random queue whose lock is free, and processing
+// takes the front of the more urgent of two random queues, so threads seldom wait on
+// each other. The price is strictness: processPatient returns one of roughly the
+// numQueues most urgent patients rather than always the most urgent one. With
+// numQueues == 1 it is a strict priority queue behind a single lock.
+
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "HeapPatientQueue.h"
+#include "patientqueue.h"
+#include "error.h"
+#include "strlib.h"
+
+using namespace std;
+
+class ConcurrentPatientQueue : public PatientQueue {
+public:
+    // constructor: numQueues heaps, or two per core if numQueues is 0
+    ConcurrentPatientQueue(int numQueues = 0);
+
+    // destructor
+    ~ConcurrentPatientQueue();
+
+    // clean up the current queue
+    void clear();
+
+    // get the front patient's name
+    string frontName();
+
+    // cheack if current queue is empty
+    bool isEmpty();
+
+    // get the most urgent patient's priority
+    int frontPriority();
+
+    // add a new paitient along with the priority
+    void newPatient(string name, int priority);
+
+    // upgrade an existing patient's priority
+    void upgradePatient(string name, int newPriority);
+
+    // remove one of the most urgent patients
+    string processPatient();
+
+    // remove one of the most urgent patients into name, or return false if there are none
+    bool tryProcessPatient(string& name);
+
+    // display the current patient queue as a string, one heap after another
+    string toString();
+
+    // get the number of heaps
+    int numQueues() const;
+
+private:
+    // one heap, with the priority of its front kept where other threads can peek at it
+    struct alignas(64) SubQueue {
+        mutex lock;
+        HeapPatientQueue queue;
+        atomic<long long> front;    // frontPriority of queue, or EMPTY_FRONT
+        int count;                  // patients in queue
+
+        SubQueue();
+        void updateFront();         // call with lock held
+    };
+
+    static const long long EMPTY_FRONT = LLONG_MAX;
+
+    vector<unique_ptr<SubQueue> > queues;
+    atomic<int> size;               // patients in all heaps
+
+    // pick a heap at random, with a random stream per thread
+    int randomQueue() const;
+
+    // find the heap with the most urgent front, or -1 if all are empty
+    int mostUrgentQueue() const;
+};
@@ -0,0 +1,367 @@
+﻿// DaryHeapPatientQueue.h
+//
+// A patient queue kept as a D-ary heap. The heap itself holds only compact keys
+// (priority, id), so percolating moves 8 bytes at a time instead of whole strings,
+// and with D = 4 or 8 the heap is shallower and each node's children share a cache
+// line. Names live in a separate table indexed by id. Ties in priority are broken by
+// name, which is only read when two priorities tie.
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "patientnode.h"
+#include "patientqueue.h"
+#include "error.h"
+#include "hashmap.h"
+#include "strlib.h"
+#include "vector.h"
+
+using namespace std;
+
+template <int D>
+class DaryHeapPatientQueue : public PatientQueue {
+public:
+    // constructor
+    DaryHeapPatientQueue();
+
+    // destructor
+    ~DaryHeapPatientQueue();
+
+    // clean up the current queue
+    void clear();
+
+    // get the front patient's name
+    string frontName();
+
+    // cheack if current queue is empty
+    bool isEmpty();
+
+    // get the most urgent patient's priority
+    int frontPriority();
+
+    // add a new paitient along with the priority
+    void newPatient(string name, int priority);
+
+    // add many patients at once
+    void newPatients(const Vector<PatientNode>& batch);
+
+    // upgrade an existing patient's priority
+    void upgradePatient(string name, int newPriority);
+
+    // remove the most urgent patient
+    string processPatient();
+
+    // remove the k most urgent patients, most urgent first
+    Vector<string> processPatients(int k);
+
+    // remove an existing patient from anywhere in the queue
+    void removePatient(string name);
+
+    // display the current patient queue as a string
+    string toString();
+
+private:
+    struct HeapKey {
+        int priority;
+        int id;                     // index into names and position
+    };
+
+    vector<HeapKey> heap;           // 0-indexed; the children of i are D * i + 1 .. D * i + D
+    vector<string> names;           // id -> name
+    vector<int> position;           // id -> index in heap, or -1 if the id is free
+    vector<int> freeIds;            // ids of processed patients, to be reused
+    HashMap<string, int> firstIds;  // id of a patient with each name
+    vector<int> nextIds;            // id -> next id with the same name, or -1
+    vector<int> prevIds;            // id -> previous id with the same name, or -1
+
+    // check if key a is more urgent than key b
+    bool moreUrgent(const HeapKey& a, const HeapKey& b) const;
+
+    // give a new patient an id, and chain it to the other patients with the name
+    int newId(const string& name);
+
+    // find the most urgent patient with a name, or throw if there is none
+    int findPatient(const string& name);
+
+    // take a patient out of the heap and free its id
+    void removeAt(int index);
+
+    // Percolate Up algorithm
+    void percolateUp(int child);
+
+    // Percolate Down algorithm
+    void percolateDown(int parent);
+};
+
+
+template <int D>
+DaryHeapPatientQueue<D>::DaryHeapPatientQueue() {
+    static_assert(D >= 2, "A heap needs at least 2 children per node.");
+}
+
+
+template <int D>
+DaryHeapPatientQueue<D>::~DaryHeapPatientQueue() {
+}
+
+
+template <int D>
+void DaryHeapPatientQueue<D>::clear() {
+    heap.clear();
+    names.clear();
+    position.clear();
+    freeIds.clear();
+    firstIds.clear();
+    nextIds.clear();
+    prevIds.clear();
+}
+
+
+template <int D>
+string DaryHeapPatientQueue<D>::frontName() {
+    if (isEmpty()) {
+        error("Attempting to return front name in an EMPTY queue.");
+    }
+    return names[heap[0].id];
+}
+
+
+template <int D>
+int DaryHeapPatientQueue<D>::frontPriority() {
+    if (isEmpty()) {
+        error("Attempting to return front priority in an EMPTY queue.");
+    }
+    return heap[0].priority;
+}
+
+
+template <int D>
+bool DaryHeapPatientQueue<D>::isEmpty() {
+    return heap.empty();
+}
+
+// log n
+template <int D>
+void DaryHeapPatientQueue<D>::newPatient(string name, int priority) {
+    // place new patient at the end, then percolate up
+    int id = newId(name);
+    heap.push_back({priority, id});
+    position[id] = heap.size() - 1;
+    percolateUp(heap.size() - 1);
+}
+
+
+// n + k when the batch is at least as big as the queue, k log n otherwise
+template <int D>
+void DaryHeapPatientQueue<D>::newPatients(const Vector<PatientNode>& batch) {
+    // a small batch goes in one patient at a time
+    if (batch.size() < (int) heap.size()) {
+        for (const PatientNode& patient : batch) {
+            newPatient(patient.name, patient.priority);
+        }
+        return;
+    }
+
+    // place the new patients behind the others in any order
+    heap.reserve(heap.size() + batch.size());
+    for (const PatientNode& patient : batch) {
+        int id = newId(patient.name);
+        heap.push_back({patient.priority, id});
+        position[id] = heap.size() - 1;
+    }
+
+    // Floyd's heapify: percolate down every parent, from the parent of the last patient
+    for (int parent = ((int) heap.size() + D - 2) / D - 1; parent >= 0; parent--) {
+        percolateDown(parent);
+    }
+}
+
+
+template <int D>
+int DaryHeapPatientQueue<D>::newId(const string& name) {
+    // reuse the id of a processed patient if there is one
+    int id;
+    if (freeIds.empty()) {
+        id = names.size();
+        names.push_back(name);
+        position.push_back(-1);
+        nextIds.push_back(-1);
+        prevIds.push_back(-1);
+    } else {
+        id = freeIds.back();
+        freeIds.pop_back();
+        names[id] = name;
+    }
+
+    // chain the id in front of the other patients with the name
+    nextIds[id] = firstIds.containsKey(name) ? firstIds[name] : -1;
+    prevIds[id] = -1;
+    if (nextIds[id] != -1) prevIds[nextIds[id]] = id;
+    firstIds[name] = id;
+    return id;
+}
+
+
+// log n
+template <int D>
+string DaryHeapPatientQueue<D>::processPatient() {
+    if (isEmpty()) {
+        error("Processing patient in an EMPTY queue.");
+    }
+
+    string removedName = names[heap[0].id];  // name for later output
+    removeAt(0);
+    return removedName;
+}
+
+
+// k log n
+template <int D>
+Vector<string> DaryHeapPatientQueue<D>::processPatients(int k) {
+    if (k < 0 || k > (int) heap.size()) {
+        error("Processing more patients than the queue holds.");
+    }
+
+    Vector<string> processed;
+    for (int i = 0; i < k; i++) {
+        processed.add(processPatient());
+    }
+    return processed;
+}
+
+
+// log n
+template <int D>
+void DaryHeapPatientQueue<D>::upgradePatient(string name, int newPriority) {
+    if (isEmpty()) {
+        error("Upgrading patient in an EMPTY queue.");
+    }
+
+    int index = position[findPatient(name)];
+    if (newPriority >= heap[index].priority) {
+        // if existing priority is already more urgent, throw exception
+        error("The existing priority is already more urgent.");
+    }
+
+    // Upgrade the new priority, then percolate up
+    heap[index].priority = newPriority;
+    percolateUp(index);
+}
+
+
+// log n
+template <int D>
+void DaryHeapPatientQueue<D>::removePatient(string name) {
+    if (isEmpty()) {
+        error("Removing patient in an EMPTY queue.");
+    }
+    removeAt(position[findPatient(name)]);
+}
+
+
+template <int D>
+string DaryHeapPatientQueue<D>::toString() {
+    string output = "";
+    for (int i = 0; i < (int) heap.size(); i++) {
+        if (i != 0) output += ", ";
+        output += integerToString(heap[i].priority) + ":" + names[heap[i].id];
+    }
+    return "{" + output + "}";
+}
+
+
+template <int D>
+bool DaryHeapPatientQueue<D>::moreUrgent(const HeapKey& a, const HeapKey& b) const {
+    if (a.priority != b.priority) return a.priority < b.priority;
+    return names[a.id] < names[b.id];  // breaking ties by string comparison
+}
+
+
+// Of the patients with the name, pick the most urgent one.
+template <int D>
+int DaryHeapPatientQueue<D>::findPatient(const string& name) {
+    if (!firstIds.containsKey(name)) {
+        // if no such patient name, throw exception
+        error("No such patient name in the queue.");
+    }
+
+    int found = firstIds[name];
+    for (int id = nextIds[found]; id != -1; id = nextIds[id]) {
+        if (moreUrgent(heap[position[id]], heap[position[found]])) found = id;
+    }
+    return found;
+}
+
+
+template <int D>
+void DaryHeapPatientQueue<D>::removeAt(int index) {
+    int id = heap[index].id;
+
+    // unchain the id from the other patients with the name
+    if (prevIds[id] != -1) {
+        nextIds[prevIds[id]] = nextIds[id];
+    } else if (nextIds[id] != -1) {
+        firstIds[names[id]] = nextIds[id];
+    } else {
+        firstIds.remove(names[id]);
+    }
+    if (nextIds[id] != -1) prevIds[nextIds[id]] = prevIds[id];
+    names[id].clear();
+    position[id] = -1;
+    freeIds.push_back(id);
+
+    // Replace the patient with last patient; it may belong above or below its new place.
+    HeapKey last = heap.back();
+    heap.pop_back();
+    if (index < (int) heap.size()) {
+        heap[index] = last;
+        position[last.id] = index;
+        percolateUp(index);
+        percolateDown(position[last.id]);
+    }
+}
+
+
+// Percolate Up algorithm: move parents down into the hole, then drop the key in.
+template <int D>
+void DaryHeapPatientQueue<D>::percolateUp(int child) {
+    HeapKey key = heap[child];
+    while (child > 0) {
+        int parent = (child - 1) / D;
+        if (!moreUrgent(key, heap[parent])) break;
+        heap[child] = heap[parent];          // move parent down
+        position[heap[child].id] = child;
+        child = parent;                      // update child index
+    }
+    heap[child] = key;
+    position[key.id] = child;
+}
+
+
+// Percolate Down algorithm: move the most urgent child up into the hole while it is
+// more urgent than the key.
+template <int D>
+void DaryHeapPatientQueue<D>::percolateDown(int parent) {
+    int size = heap.size();
+    HeapKey key = heap[parent];
+    while (true) {
+        int first = D * parent + 1;
+        if (first >= size) break;             // no children
+
+        // find the most urgent of up to D children
+        int best = first;
+        int last = min(first + D, size);
+        for (int child = first + 1; child < last; child++) {
+            if (moreUrgent(heap[child], heap[best])) best = child;
+        }
+        if (!moreUrgent(heap[best], key)) break;
+
+        heap[parent] = heap[best];            // move child up
+        position[heap[parent].id] = parent;
+        parent = best;                        // update parent index
+    }
+    heap[parent] = key;
+    position[key.id] = parent;
+}
@@ -9,7 +9,9 @@ HeapPatientQueue::HeapPatientQueue() {
 
 HeapPatientQueue::~HeapPatientQueue() {
     delete [] PQueue;
+    delete [] ids;
     PQueue = nullptr; // advoid dangling pionter
+    ids = nullptr;
 }
 
 
@@ -17,12 +19,17 @@ void HeapPatientQueue::clear() {
     // free memory if necessary
     if (PQueue != nullptr) {
         delete [] PQueue;
+        delete [] ids;
     }
 
     // intialize a new patient queue
     capacity = IINITIAL_CAPACITY;
     PQueue = new PatientNode[capacity];
+    ids = new int[capacity];
     size = 0;
+    slots.clear();
+    freeIds.clear();
+    nameIds.clear();
 }
 
 
@@ -40,6 +47,16 @@ bool HeapPatientQueue::isEmpty() {
     return size == 0;
 }
 
+
+bool HeapPatientQueue::contains(string name) {
+    return nameIds.containsKey(name);
+}
+
+
+int HeapPatientQueue::priorityOf(string name) {
+    return PQueue[findPatient(name)].priority;
+}
+
 // log n
 void HeapPatientQueue::newPatient(string name, int priority){
     // if non-empty queue but size is full
@@ -49,14 +66,41 @@ void HeapPatientQueue::newPatient(string name, int priority){
 
     // place new patient at the first empty index
     size++;
-    PQueue[size].name = name;
-    PQueue[size].priority = priority;
+    placePatient(size, name, priority);
 
     // percolate up
     percolateUp(size);
 }
 
 
+// n + k when the batch is at least as big as the queue, k log n otherwise
+void HeapPatientQueue::newPatients(const Vector<PatientNode>& batch) {
+    // a small batch goes in one patient at a time
+    if (batch.size() < size) {
+        for (const PatientNode& patient : batch) {
+            newPatient(patient.name, patient.priority);
+        }
+        return;
+    }
+
+    // make room for all of them; percolateDown may look one past the last patient
+    while (size + batch.size() + 2 > capacity) {
+        expandCapacity();
+    }
+
+    // place the new patients behind the others in any order
+    for (const PatientNode& patient : batch) {
+        size++;
+        placePatient(size, patient.name, patient.priority);
+    }
+
+    // Floyd's heapify: percolate down every parent, the last one first
+    for (int parent = size / 2; parent >= 1; parent--) {
+        percolateDown(parent);
+    }
+}
+
+
 // log n
 string HeapPatientQueue::processPatient() {
     if (isEmpty()) {
@@ -66,8 +110,8 @@ string HeapPatientQueue::processPatient() {
     string removedName = frontName();  // name for later output
 
     // Replace the front with last patient.
-    swap(PQueue[1], PQueue[size]);
-    size--;  // remove the last patient
+    swapPatients(1, size);
+    removeLast();  // remove the last patient
 
     // Percolate down the front patient.
     percolateDown(1);
@@ -76,23 +120,29 @@ string HeapPatientQueue::processPatient() {
 }
 
 
-// n
+// k log n
+Vector<string> HeapPatientQueue::processPatients(int k) {
+    if (k < 0 || k > size) {
+        error("Processing more patients than the queue holds.");
+    }
+
+    Vector<string> processed;
+    for (int i = 0; i < k; i++) {
+        processed.add(processPatient());
+    }
+    return processed;
+}
+
+
+// log n
 void HeapPatientQueue::upgradePatient(string name, int newPriority) {
     if (isEmpty()) {
         error("Upgrading patient in an EMPTY queue.");
     }
 
-    // Search through heap to find the specified patient
-    int indexToFind;  // the index of the specified patient
-    for (indexToFind = 1; indexToFind <= size; indexToFind++) {
-        if (PQueue[indexToFind].name == name) break;
-    }
-
-    // Now currIndex is the index of the specifed patient:
-    if (indexToFind > size) {
-        // if no such patient name, throw exception
-        error("No such patient name in the queue.");
-    } else if (newPriority >= PQueue[indexToFind].priority) {
+    // Look up the specified patient, the first one in the heap if the name repeats
+    int indexToFind = findPatient(name);
+    if (newPriority >= PQueue[indexToFind].priority) {
         // if existing priority is already more urgent, throw exception
         error("The existing priority is already more urgent.");
     }
@@ -105,6 +155,25 @@ void HeapPatientQueue::upgradePatient(string name, int newPriority) {
 }
 
 
+// log n
+void HeapPatientQueue::removePatient(string name) {
+    if (isEmpty()) {
+        error("Removing patient in an EMPTY queue.");
+    }
+
+    // Replace the patient with last patient.
+    int indexToRemove = findPatient(name);
+    swapPatients(indexToRemove, size);
+    removeLast();  // remove the last patient
+
+    // The last patient may belong above or below its new place.
+    if (indexToRemove <= size) {
+        percolateUp(indexToRemove);
+        percolateDown(indexToRemove);
+    }
+}
+
+
 string HeapPatientQueue::toString() {
     string output = "";
     for (int i = 1; i <= size; i++) {
@@ -115,12 +184,74 @@ string HeapPatientQueue::toString() {
 }
 
 
+// Give the patient an id, reusing a free one, and list it under the name.
+void HeapPatientQueue::placePatient(int slot, const string& name, int priority) {
+    int id;
+    if (freeIds.empty()) {
+        id = slots.size();
+        slots.push_back(0);
+    } else {
+        id = freeIds.back();
+        freeIds.pop_back();
+    }
+
+    PQueue[slot].name = name;
+    PQueue[slot].priority = priority;
+    ids[slot] = id;
+    slots[id] = slot;
+    nameIds[name].add(id);
+}
+
+
+// Free the last patient's id and take it off the list of its name.
+void HeapPatientQueue::removeLast() {
+    int id = ids[size];
+    Vector<int>& sameName = nameIds[PQueue[size].name];
+    for (int i = 0; i < sameName.size(); i++) {
+        if (sameName[i] == id) {
+            sameName[i] = sameName[sameName.size() - 1];
+            sameName.remove(sameName.size() - 1);
+            break;
+        }
+    }
+    if (sameName.isEmpty()) nameIds.remove(PQueue[size].name);
+
+    slots[id] = 0;
+    freeIds.push_back(id);
+    size--;
+}
+
+
+// Of the patients with the name, pick the one with the smallest heap index.
+int HeapPatientQueue::findPatient(const string& name) {
+    if (!nameIds.containsKey(name)) {
+        // if no such patient name, throw exception
+        error("No such patient name in the queue.");
+    }
+
+    int found = 0;
+    for (int id : nameIds[name]) {
+        if (found == 0 || slots[id] < found) found = slots[id];
+    }
+    return found;
+}
+
+
+// Swap two patients and move their ids along with them.
+void HeapPatientQueue::swapPatients(int a, int b) {
+    swap(PQueue[a], PQueue[b]);
+    swap(ids[a], ids[b]);
+    slots[ids[a]] = a;
+    slots[ids[b]] = b;
+}
+
+
 // Percolate Up algorithm
 void HeapPatientQueue::percolateUp(int child) {
     // percolate up by swapping with its parent
     int parent = child / 2;
     while (child != 1 && PQueue[parent].priority > PQueue[child].priority) {
-        swap(PQueue[parent], PQueue[child]); // swap child and parent
+        swapPatients(parent, child);         // swap child and parent
         child = parent;                      // update child index
         parent = child / 2;                  // update parent index
     }
@@ -139,7 +270,7 @@ void HeapPatientQueue::percolateDown(int parent) {
         if (right > size) {
             if (PQueue[parent].priority >= PQueue[left].priority) {
                 // if left child is urgent than or equal to parent
-                swap(PQueue[parent], PQueue[left]);  // swap the left child
+                swapPatients(parent, left);          // swap the left child
                 parent = left;                       // update parent index
             }
             break; // Done for percolating! Now in correct order along with only one child
@@ -148,19 +279,19 @@ void HeapPatientQueue::percolateDown(int parent) {
         // CASE 2: has 2 children.
         if (PQueue[left].priority < PQueue[right].priority) {
             // left child is more urgent.
-            swap(PQueue[parent], PQueue[left]);  // swap the left child
+            swapPatients(parent, left);          // swap the left child
             parent = left;                       // update parent index
         } else if (PQueue[left].priority > PQueue[right].priority){
             // right child is more urgent.
-            swap(PQueue[parent], PQueue[right]); // swap the right child
+            swapPatients(parent, right);         // swap the right child
             parent = right;                      // update parent index
         } else {
             // left child and right child have a tie in priority.
             if (PQueue[left].name < PQueue[right].name) { // breaking ties by string comparison
-                    swap(PQueue[parent], PQueue[left]);   // swap the left child
+                    swapPatients(parent, left);      // swap the left child
                 parent = left;                       // update parent index
             } else {
-                swap(PQueue[parent], PQueue[right]); // swap the right child
+                swapPatients(parent, right);         // swap the right child
                 parent = right;                      // update parent index
             }
         }
@@ -175,9 +306,13 @@ void HeapPatientQueue::percolateDown(int parent) {
 void HeapPatientQueue::expandCapacity() {
     capacity *= 2; // update capacity first (private variable)
     PatientNode* newPQ = new PatientNode[capacity];
+    int* newIds = new int[capacity];
     for (int i = 0; i <= size; i++) {
         newPQ[i] = PQueue[i];
+        newIds[i] = ids[i];
     }
     delete [] PQueue;
+    delete [] ids;
     PQueue = newPQ;
+    ids = newIds;
 }
@@ -4,10 +4,13 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 #include "patientnode.h"
 #include "patientqueue.h"
 #include "error.h"
+#include "hashmap.h"
 #include "strlib.h"
+#include "vector.h"
 
 using namespace std;
 
@@ -30,25 +33,56 @@ public:
     // cheack if current queue is empty
     bool isEmpty();
 
+    // check if a patient with the name is in the queue
+    bool contains(string name);
+
+    // get the priority of the patient upgradePatient would pick for the name
+    int priorityOf(string name);
+
     // get the most urgent patient's priority
     int frontPriority();
 
     // add a new paitient along with the priority
     void newPatient(string name, int priority);
 
+    // add many patients at once
+    void newPatients(const Vector<PatientNode>& batch);
+
     // upgrade an existing patient's priority
     void upgradePatient(string name, int newPriority);
 
     // remove the most urgent patient
     string processPatient();
 
+    // remove the k most urgent patients, most urgent first
+    Vector<string> processPatients(int k);
+
+    // remove an existing patient from anywhere in the queue
+    void removePatient(string name);
+
     // display the current patient queue as a string
     string toString();
 
 private:
     PatientNode* PQueue = nullptr;  // a patient queue pionter to the most urgent patient
+    int* ids = nullptr;             // heap index -> id of the patient there
     int capacity;                   // total capacity of the queue
     int size;                       // current size of the queue
+    vector<int> slots;              // id -> heap index of the patient, or 0 if the id is free
+    vector<int> freeIds;            // ids of processed patients, to be reused
+    HashMap<string, Vector<int> > nameIds; // ids of the patients with each name
+
+    // put a new patient in heap index slot, giving it an id
+    void placePatient(int slot, const string& name, int priority);
+
+    // remove the patient in the last heap index, freeing its id
+    void removeLast();
+
+    // find the heap index of the first patient with the name, or throw if there is none
+    int findPatient(const string& name);
+
+    // swap two patients and keep their heap indexes up to date
+    void swapPatients(int a, int b);
 
     // Percolate Up algorithm
     void percolateUp(int child);
@@ -2,13 +2,18 @@
 
 #include "LinkedListPatientQueue.h"
 
-LinkedListPatientQueue::LinkedListPatientQueue() {
+LinkedListPatientQueue::LinkedListPatientQueue(bool usePool) {
     head = nullptr;
+    pooled = usePool;
+    freeNodes = nullptr;
 }
 
 
 LinkedListPatientQueue::~LinkedListPatientQueue() {
     clear();
+    for (PatientNode* slab : slabs) {
+        delete [] slab;
+    }
 }
 
 
@@ -19,7 +24,7 @@ void LinkedListPatientQueue::clear() {
     while (currP != nullptr) {
         trash = currP;
         currP = currP->next;
-        delete trash;
+        freeNode(trash);
     }
 
     // Reset head and trash
@@ -49,7 +54,7 @@ bool LinkedListPatientQueue::isEmpty() {
 
 
 void LinkedListPatientQueue::newPatient(string name, int priority) {
-    PatientNode* newPatient = new PatientNode(name, priority, nullptr);
+    PatientNode* newPatient = allocateNode(name, priority, nullptr);
     PatientNode* currP = head;
     PatientNode* preP = nullptr;
 
@@ -71,6 +76,20 @@ void LinkedListPatientQueue::newPatient(string name, int priority) {
 }
 
 
+void LinkedListPatientQueue::newPatients(const Vector<PatientNode>& batch) {
+    // chain copies of the new patients in the order given
+    PatientNode* chain = nullptr;
+    PatientNode** tail = &chain;
+    for (const PatientNode& patient : batch) {
+        *tail = allocateNode(patient.name, patient.priority, nullptr);
+        tail = &(*tail)->next;
+    }
+
+    // patients already in the queue stay in front of new ones of equal priority
+    head = merge(head, mergeSort(chain));
+}
+
+
 string LinkedListPatientQueue::processPatient() {
     if (isEmpty()) {
         error("Attempting to process patient in an EMPTY queue.");
@@ -78,12 +97,30 @@ string LinkedListPatientQueue::processPatient() {
     string nameToReturn  = head->name;
     PatientNode* trash = head;
     head = head->next;
-    delete trash;
+    freeNode(trash);
 
     return nameToReturn;
 }
 
 
+Vector<string> LinkedListPatientQueue::processPatients(int k) {
+    // check that there are k patients before removing any of them
+    int count = 0;
+    for (PatientNode* currP = head; currP != nullptr && count < k; currP = currP->next) {
+        count++;
+    }
+    if (k < 0 || count < k) {
+        error("Attempting to process more patients than the queue holds.");
+    }
+
+    Vector<string> processed;
+    for (int i = 0; i < k; i++) {
+        processed.add(processPatient());
+    }
+    return processed;
+}
+
+
 void LinkedListPatientQueue::upgradePatient(string name, int newPriority) {
     // if empty queue, throw exception
     if (isEmpty()) {
@@ -104,7 +141,7 @@ void LinkedListPatientQueue::upgradePatient(string name, int newPriority) {
 
             if (currP != head && newPriority < preP->priority) { // if the paitent needs to change position
                 preP->next = currP->next;
-                delete currP;                  // delete the current patient
+                freeNode(currP);               // delete the current patient
                 newPatient(name, newPriority); // re-insert the patient
             } else {                           // else just update the priority
                 currP->priority = newPriority;
@@ -120,6 +157,78 @@ void LinkedListPatientQueue::upgradePatient(string name, int newPriority) {
 }
 
 
+PatientNode* LinkedListPatientQueue::allocateNode(const string& name, int priority, PatientNode* next) {
+    if (!pooled) {
+        return new PatientNode(name, priority, next);
+    }
+
+    // cut a new slab into free nodes when there are none left
+    if (freeNodes == nullptr) {
+        PatientNode* slab = new PatientNode[SLAB_NODES];
+        slabs.add(slab);
+        for (int i = 0; i < SLAB_NODES; i++) {
+            slab[i].next = (i + 1 < SLAB_NODES) ? &slab[i + 1] : nullptr;
+        }
+        freeNodes = slab;
+    }
+
+    PatientNode* node = freeNodes;
+    freeNodes = node->next;
+    node->name = name;   // reuses the old name's buffer when it fits
+    node->priority = priority;
+    node->next = next;
+    return node;
+}
+
+
+void LinkedListPatientQueue::freeNode(PatientNode* node) {
+    if (!pooled) {
+        delete node;
+        return;
+    }
+    node->next = freeNodes;
+    freeNodes = node;
+}
+
+
+// Split the chain in halves, sort each half, then merge them.
+PatientNode* LinkedListPatientQueue::mergeSort(PatientNode* list) {
+    if (list == nullptr || list->next == nullptr) {
+        return list;
+    }
+
+    // the slow pointer stops at the end of the first half
+    PatientNode* slow = list;
+    PatientNode* fast = list->next;
+    while (fast != nullptr && fast->next != nullptr) {
+        slow = slow->next;
+        fast = fast->next->next;
+    }
+    PatientNode* second = slow->next;
+    slow->next = nullptr;
+
+    return merge(mergeSort(list), mergeSort(second));
+}
+
+
+PatientNode* LinkedListPatientQueue::merge(PatientNode* first, PatientNode* second) {
+    PatientNode* merged = nullptr;
+    PatientNode** tail = &merged;
+    while (first != nullptr && second != nullptr) {
+        if (second->priority < first->priority) { // only a more urgent patient jumps ahead
+            *tail = second;
+            second = second->next;
+        } else {
+            *tail = first;
+            first = first->next;
+        }
+        tail = &(*tail)->next;
+    }
+    *tail = (first != nullptr) ? first : second;
+    return merged;
+}
+
+
 string LinkedListPatientQueue::toString() {
     string output = "";
     PatientNode* currP = head;
@@ -8,18 +8,23 @@
 #include "patientqueue.h"
 #include "error.h"
 #include "strlib.h"
+#include "vector.h"
 
 using namespace std;
 
+const int SLAB_NODES = 256; // patient nodes allocated at once by a pooled queue
+
 class LinkedListPatientQueue : public PatientQueue {
 public:
     /*
      * Method: VectorPatientQueue
      * Usage: VectorPatientQueue PQ;
      * ----------------------
-     * Initialize a new empty patient queue
+     * Initialize a new empty patient queue. With usePool, the queue takes its nodes
+     * from slabs of SLAB_NODES it owns and keeps freed nodes on a free list for reuse;
+     * otherwise every node is allocated with new and freed with delete.
      */
-    LinkedListPatientQueue();
+    LinkedListPatientQueue(bool usePool = true);
 
     /*
      * Method: ~VectorPatientQueue
@@ -70,6 +75,15 @@ public:
      */
     void newPatient(string name, int priority);
 
+    /*
+     * Method: newPatients
+     * Usage: PQ.newPatients(batch);
+     * ----------------------
+     * Add many patients at once: sort them, then merge them into the queue in one pass.
+     * Patients of equal priority end up in the same order as after adding them one by one.
+     */
+    void newPatients(const Vector<PatientNode>& batch);
+
     /*
      * Method: processPatient
      * Usage: cout << PQ.processPatient();
@@ -78,6 +92,14 @@ public:
      */
     string processPatient();
 
+    /*
+     * Method: processPatients
+     * Usage: Vector<string> names = PQ.processPatients(k);
+     * ----------------------
+     * Remove the k most urgent patients and return their names, most urgent first.
+     */
+    Vector<string> processPatients(int k);
+
     /*
      * Method: upgradePatient
      * Usage: PQ.upgradePatient();
@@ -96,4 +118,27 @@ public:
 
 private:
     PatientNode* head; /* Pointer to the patient at the queue head */
+    bool pooled;       /* Whether nodes come from the slabs */
+    Vector<PatientNode*> slabs;  /* Arrays of SLAB_NODES nodes owned by the queue */
+    PatientNode* freeNodes;      /* Chain of unused nodes from the slabs */
+
+    /*
+     * Method: allocateNode / freeNode
+     * Usage: PatientNode* node = allocateNode(name, priority, next);
+     * ----------------------
+     * Get a node from the free list, cutting a new slab when it runs out, or give one
+     * back to it. Both are O(1); without pooling they are new and delete.
+     */
+    PatientNode* allocateNode(const string& name, int priority, PatientNode* next);
+    void freeNode(PatientNode* node);
+
+    /*
+     * Method: mergeSort / merge
+     * Usage: list = mergeSort(list);
+     * ----------------------
+     * Sort a chain of patients by priority, or merge two sorted chains. On ties, patients
+     * from the earlier part of the chain, or from the first chain, come first.
+     */
+    static PatientNode* mergeSort(PatientNode* list);
+    static PatientNode* merge(PatientNode* first, PatientNode* second);
 };
@@ -1,6 +1,8 @@
 // VectorPatientQueue.cpp
 
 #include "VectorPatientQueue.h"
+#include <algorithm>
+#include <vector>
 
 // constructor
 VectorPatientQueue::VectorPatientQueue() {}
@@ -70,6 +72,13 @@ void VectorPatientQueue::newPatient(string name, int priority) {
 }
 
 
+void VectorPatientQueue::newPatients(const Vector<PatientNode>& batch) {
+    for (const PatientNode& patient : batch) {
+        newPatient(patient.name, patient.priority);
+    }
+}
+
+
 string VectorPatientQueue::processPatient() {
     // throw exception when accessing an empty list
     if (isEmpty()) {
@@ -85,6 +94,40 @@ string VectorPatientQueue::processPatient() {
 }
 
 
+// n log k
+Vector<string> VectorPatientQueue::processPatients(int k) {
+    // throw exception when there are not enough patients
+    if (k < 0 || k > patients.size()) {
+        error("Attempting to process more patients than the queue holds.");
+    }
+
+    // the k most urgent indexes; ties go to the lower index, as in mostUrgentIndex
+    std::vector<int> order(patients.size());
+    for (int i = 0; i < patients.size(); i++) {
+        order[i] = i;
+    }
+    partial_sort(order.begin(), order.begin() + k, order.end(), [this](int a, int b) {
+        return patients[a].priority < patients[b].priority
+            || (patients[a].priority == patients[b].priority && a < b);
+    });
+
+    // take their names, then keep everybody else in order
+    Vector<string> processed;
+    std::vector<bool> taken(patients.size(), false);
+    for (int i = 0; i < k; i++) {
+        processed.add(patients[order[i]].name);
+        taken[order[i]] = true;
+    }
+    Vector<patientT> remaining;
+    for (int i = 0; i < patients.size(); i++) {
+        if (!taken[i]) remaining.add(patients[i]);
+    }
+    patients = remaining;
+
+    return processed;
+}
+
+
 void VectorPatientQueue::upgradePatient(string name, int newPriority) {
     int minPriority = MAXIMUM_PRIORITY; // set to maximum so that it can be updated in the loop's firt iteration.
     int index = -1;                     // set initial index as -1 to indicat that patient is not found
@@ -4,6 +4,7 @@
 
 #include <iostream>
 #include <string>
+#include "patientnode.h"
 #include "patientqueue.h"
 #include "vector.h"
 
@@ -54,6 +55,14 @@ public:
      */
     void newPatient(string name, int priority);
 
+    /*
+     * Method: newPatients
+     * Usage: PQ.newPatients(batch);
+     * ----------------------
+     * Puts many people into the patient queue at once, append to a vector
+     */
+    void newPatients(const Vector<PatientNode>& batch);
+
     /*
      * Method: frontPriority
      * Usage: cout << PQ.frontPriority();
@@ -78,6 +87,15 @@ public:
      */
     string processPatient();
 
+    /*
+     * Method: processPatients
+     * Usage: Vector<string> names = PQ.processPatients(k);
+     * ----------------------
+     * Sort the k highest-priority patients out of the vector in one pass, remove them
+     * and return their names in the order processPatient would have.
+     */
+    Vector<string> processPatients(int k);
+
 
     /*
      * Method: upgradePatient
@@ -0,0 +1,183 @@
+// patientqueuebench.cpp
+//
+// Benchmark of the heap patient queues on push/pop-heavy workloads: load N patients
+// and process them all, hold the queue at N patients while every round processes one
+// and admits another, and last load all N with one call to newPatients. Every queue
+// must process the same priorities in the same order. Then churns a short
+// LinkedListPatientQueue with new/delete per node and with its node pool. Built on
+// its own (define PATIENT_QUEUE_BENCH_MAIN) so it does not clash with the assignment's main.
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "DaryHeapPatientQueue.h"
+#include "HeapPatientQueue.h"
+#include "LinkedListPatientQueue.h"
+#include "patientnode.h"
+#include "random.h"
+#include "strlib.h"
+#include "vector.h"
+
+using namespace std;
+
+// the timings of one queue, and the priorities it processed in order
+struct BenchResult {
+    string label;
+    double loadSeconds = 0;
+    double drainSeconds = 0;
+    double holdSeconds = 0;
+    double bulkSeconds = 0;
+    Vector<int> processed;
+};
+
+// Run the workloads on fresh queues of type Q.
+template <typename Q>
+BenchResult runQueue(const string& label, const Vector<string>& names, const Vector<int>& priorities,
+                     const Vector<PatientNode>& patients, int rounds) {
+    BenchResult result;
+    result.label = label;
+    Q queue;
+    int n = names.size();
+
+    // load all, then process all
+    auto startTime = chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        queue.newPatient(names[i], priorities[i]);
+    }
+    auto loadedTime = chrono::steady_clock::now();
+    while (!queue.isEmpty()) {
+        result.processed.add(queue.frontPriority());
+        queue.processPatient();
+    }
+    auto drainedTime = chrono::steady_clock::now();
+
+    // hold the queue at n patients: one out, one in, reusing the first patients
+    for (int i = 0; i < n; i++) {
+        queue.newPatient(names[i], priorities[i]);
+    }
+    auto holdTime = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        result.processed.add(queue.frontPriority());
+        queue.processPatient();
+        queue.newPatient(names[r % n], priorities[(r * 7 + 3) % n]);
+    }
+    auto endTime = chrono::steady_clock::now();
+
+    // load all at once into an empty queue
+    Q bulk;
+    auto bulkTime = chrono::steady_clock::now();
+    bulk.newPatients(patients);
+    result.bulkSeconds = chrono::duration<double>(chrono::steady_clock::now() - bulkTime).count();
+    if (bulk.frontPriority() != result.processed[0]) {
+        error(label + " has the wrong front patient after newPatients.");
+    }
+
+    result.loadSeconds = chrono::duration<double>(loadedTime - startTime).count();
+    result.drainSeconds = chrono::duration<double>(drainedTime - loadedTime).count();
+    result.holdSeconds = chrono::duration<double>(endTime - holdTime).count();
+    return result;
+}
+
+// Churn a linked-list queue of about listSize patients: every round processes one
+// patient and admits another, and every listSize rounds the queue is emptied and
+// refilled. Returns the time taken; the names processed are added to processed.
+double runListChurn(bool pooled, const Vector<string>& names, const Vector<int>& priorities,
+                    int listSize, int rounds, Vector<string>& processed) {
+    LinkedListPatientQueue queue(pooled);
+    int n = names.size();
+
+    auto startTime = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        if (r % listSize == 0) {
+            queue.clear();
+            for (int i = 0; i < listSize; i++) {
+                queue.newPatient(names[(r + i) % n], priorities[(r + i) % n]);
+            }
+        }
+        processed.add(queue.processPatient());
+        queue.newPatient(names[r % n], priorities[(r * 7 + 3) % n]);
+    }
+    return chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+}
+
+// Print one line of the results table.
+void printResult(const BenchResult& result, int n, int rounds) {
+    cout << setw(24) << left << result.label << right << fixed << setprecision(1)
+         << setw(12) << result.loadSeconds * 1e9 / n
+         << setw(12) << result.drainSeconds * 1e9 / n
+         << setw(12) << (rounds > 0 ? result.holdSeconds * 1e9 / rounds : 0)
+         << setw(12) << result.bulkSeconds * 1e9 / n << endl;
+}
+
+#ifdef PATIENT_QUEUE_BENCH_MAIN
+/*
+ * Usage: patientqueuebench [-patients N] [-rounds N] [-seed N] [-listsize N]
+ */
+int main(int argc, char** argv) {
+    int n = 1000000, rounds = 1000000, seed = 1, listSize = 32;
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "-patients" && hasValue) {
+            n = atoi(argv[++i]);
+        } else if (option == "-rounds" && hasValue) {
+            rounds = atoi(argv[++i]);
+        } else if (option == "-seed" && hasValue) {
+            seed = atoi(argv[++i]);
+        } else if (option == "-listsize" && hasValue) {
+            listSize = atoi(argv[++i]);
+        } else {
+            cerr << "unknown option " << option << endl;
+            return 1;
+        }
+    }
+    if (n <= 0 || rounds < 0 || listSize <= 0) {
+        cerr << "there must be at least one patient" << endl;
+        return 1;
+    }
+
+    // distinct names, random priorities
+    setRandomSeed(seed);
+    Vector<string> names;
+    Vector<int> priorities;
+    Vector<PatientNode> patients;
+    for (int i = 0; i < n; i++) {
+        names.add("Patient" + integerToString(i));
+        priorities.add(randomInteger(1, n));
+        patients.add(PatientNode(names[i], priorities[i]));
+    }
+
+    Vector<BenchResult> results;
+    results.add(runQueue<HeapPatientQueue>("HeapPatientQueue", names, priorities, patients, rounds));
+    results.add(runQueue<DaryHeapPatientQueue<2> >("DaryHeapPatientQueue<2>", names, priorities, patients, rounds));
+    results.add(runQueue<DaryHeapPatientQueue<4> >("DaryHeapPatientQueue<4>", names, priorities, patients, rounds));
+    results.add(runQueue<DaryHeapPatientQueue<8> >("DaryHeapPatientQueue<8>", names, priorities, patients, rounds));
+
+    cout << n << " patients, " << rounds << " rounds; ns per operation" << endl;
+    cout << setw(24) << left << "queue" << right << setw(12) << "newPatient"
+         << setw(12) << "process" << setw(12) << "round" << setw(12) << "newPatients" << endl;
+    bool same = true;
+    for (const BenchResult& result : results) {
+        printResult(result, n, rounds);
+        if (result.processed != results[0].processed) {
+            cerr << result.label << " processed patients in a different order" << endl;
+            same = false;
+        }
+    }
+
+    // the list walks to its insertion point, so keep it short to leave the allocator
+    // as the main cost
+    Vector<string> withNew, withPool;
+    double newSeconds = runListChurn(false, names, priorities, listSize, rounds, withNew);
+    double poolSeconds = runListChurn(true, names, priorities, listSize, rounds, withPool);
+    cout << "LinkedListPatientQueue of " << listSize << ", ns per round: new/delete "
+         << newSeconds * 1e9 / max(1, rounds) << ", pool " << poolSeconds * 1e9 / max(1, rounds) << endl;
+    if (withNew != withPool) {
+        cerr << "the pooled list processed patients in a different order" << endl;
+        same = false;
+    }
+    return same ? 0 : 1;
+}
+#endif // PATIENT_QUEUE_BENCH_MAIN
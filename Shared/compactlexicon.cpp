@@ -0,0 +1,297 @@
+//
+//  compactlexicon.cpp
+//
+//  Created by Jian Zhong on 7/20/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#include "compactlexicon.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <unordered_map>
+#include "error.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A dictionary file is a header of four 32-bit words (magic, version, word count, node
+// count) followed by the nodes as they are in memory, in the byte order of the machine
+// that wrote it.
+const uint32_t FILE_MAGIC = 0x58454c43;  // "CLEX" on a little-endian machine
+const uint32_t FILE_VERSION = 2;
+const int FILE_HEADER_WORDS = 4;
+
+CompactLexicon::CompactLexicon() : nodes(nullptr), nodeCount(0), wordCount(0) {
+}
+
+CompactLexicon::CompactLexicon(const Lexicon& lexicon) : CompactLexicon() {
+    vector<string> words;
+    for (string word : lexicon) {
+        words.push_back(word);
+    }
+    build(words);
+}
+
+CompactLexicon::CompactLexicon(const vector<string>& words) : CompactLexicon() {
+    build(words);
+}
+
+void CompactLexicon::build(vector<string> words) {
+    // keep the plain A-Z words, lower case and sorted, so each prefix is a contiguous range
+    int kept = 0;
+    for (string& word : words) {
+        bool letters = !word.empty();
+        for (char& ch : word) {
+            ch = tolower((unsigned char) ch);
+            if (ch < 'a' || ch > 'z') letters = false;
+        }
+        if (letters) swap(words[kept++], word);
+    }
+    words.resize(kept);
+    sort(words.begin(), words.end());
+    words.erase(unique(words.begin(), words.end()), words.end());
+    wordCount = words.size();
+
+    // a node still to lay out: words[lo, hi) share its prefix of length depth
+    struct PendingNode {
+        int node, lo, hi, depth;
+    };
+
+    vector<PendingNode> queue;
+    storage.assign(1, {0, 0, 0});
+    queue.push_back({ROOT, 0, (int) words.size(), 0});
+
+    for (size_t q = 0; q < queue.size(); q++) {
+        PendingNode pending = queue[q];
+        Node& node = storage[pending.node];
+
+        // a word equal to the prefix sorts first
+        int lo = pending.lo;
+        if (lo < pending.hi && (int) words[lo].length() == pending.depth) {
+            node.childMask |= WORD_BIT;
+            lo++;
+        }
+        if (lo == pending.hi) continue;
+
+        // one child per distinct next letter
+        int first = storage.size();
+        node.firstChild = first;
+        int count = 0;
+        for (int i = lo; i < pending.hi; i++) {
+            if (i == lo || words[i][pending.depth] != words[i - 1][pending.depth]) {
+                node.childMask |= 1u << (words[i][pending.depth] - 'a');
+                if (count > 0) queue.back().hi = i;
+                queue.push_back({first + count, i, pending.hi, pending.depth + 1});
+                count++;
+            }
+        }
+        storage.resize(first + count, {0, 0, 0}); // node is not used after this
+    }
+
+    // count the words below every node, children first, and number the siblings with
+    // them; the height of a node is one more than its highest child's
+    vector<int> wordsBelow(storage.size(), 0);
+    for (int n = storage.size() - 1; n >= 0; n--) {
+        int first = storage[n].firstChild;
+        int size = popcount(storage[n].childMask & LETTER_BITS);
+        int below = 0;
+        uint32_t height = 0;
+        for (int c = first; c < first + size; c++) {
+            storage[c].wordsBefore = below;
+            below += wordsBelow[c];
+            height = max(height, ((storage[c].childMask & HEIGHT_BITS) >> HEIGHT_SHIFT) + 1);
+        }
+        wordsBelow[n] = below + ((storage[n].childMask & WORD_BIT) != 0);
+        storage[n].childMask |= min(height, (uint32_t) MAX_HEIGHT) << HEIGHT_SHIFT;
+    }
+
+    minimize();
+}
+
+void CompactLexicon::minimize() {
+    int count = storage.size();
+    vector<int> blockOf(count, -1);  // node -> number of its child block, or -1
+    vector<int> blockFirst;          // block number -> first node of one copy of it
+    vector<int> blockSize;
+    unordered_map<string, int> blockNumbers;
+
+    string key;
+    for (int n = count - 1; n >= 0; n--) {
+        int size = popcount(storage[n].childMask & LETTER_BITS);
+        if (size == 0) continue;
+
+        int first = storage[n].firstChild;
+        key.clear();
+        for (int c = first; c < first + size; c++) {
+            uint32_t entry[2] = {storage[c].childMask, (uint32_t) blockOf[c]};
+            key.append((const char*) entry, sizeof(entry));
+        }
+
+        auto found = blockNumbers.find(key);
+        if (found == blockNumbers.end()) {
+            found = blockNumbers.insert(make_pair(key, (int) blockFirst.size())).first;
+            blockFirst.push_back(first);
+            blockSize.push_back(size);
+        }
+        blockOf[n] = found->second;
+    }
+
+    // give each distinct block one place, breadth first from the root's children
+    vector<int> position(blockFirst.size(), -1);
+    vector<int> order;
+    int next = 1;
+    auto place = [&](int block) {
+        if (block >= 0 && position[block] < 0) {
+            position[block] = next;
+            next += blockSize[block];
+            order.push_back(block);
+        }
+    };
+    place(blockOf[ROOT]);
+    for (size_t q = 0; q < order.size(); q++) {
+        for (int i = 0; i < blockSize[order[q]]; i++) {
+            place(blockOf[blockFirst[order[q]] + i]);
+        }
+    }
+
+    vector<Node> merged(next);
+    merged[ROOT].childMask = storage[ROOT].childMask;
+    merged[ROOT].firstChild = blockOf[ROOT] >= 0 ? position[blockOf[ROOT]] : 0;
+    for (int block : order) {
+        for (int i = 0; i < blockSize[block]; i++) {
+            int n = blockFirst[block] + i;
+            merged[position[block] + i].childMask = storage[n].childMask;
+            merged[position[block] + i].firstChild = blockOf[n] >= 0 ? position[blockOf[n]] : 0;
+            merged[position[block] + i].wordsBefore = storage[n].wordsBefore;
+        }
+    }
+
+    storage.swap(merged);
+    nodes = storage.data();
+    nodeCount = storage.size();
+}
+
+shared_ptr<const CompactLexicon> CompactLexicon::open(const string& fileName) {
+    ifstream input(fileName, ios::binary);
+    if (!input) error("CompactLexicon: cannot open " + fileName);
+
+    uint32_t header[FILE_HEADER_WORDS] = {0};
+    input.read((char*) header, sizeof(header));
+    if (!input || header[0] != FILE_MAGIC) {
+        // not a dictionary file, so a word list
+        input.clear();
+        input.seekg(0);
+        vector<string> words;
+        string word;
+        while (input >> word) {
+            words.push_back(word);
+        }
+        return shared_ptr<const CompactLexicon>(new CompactLexicon(words));
+    }
+    if (header[1] != FILE_VERSION) error("CompactLexicon: unknown version of " + fileName);
+
+    shared_ptr<CompactLexicon> lexicon(new CompactLexicon());
+    lexicon->wordCount = header[2];
+    lexicon->nodeCount = header[3];
+    size_t bytes = sizeof(header) + (size_t) lexicon->nodeCount * sizeof(Node);
+
+#ifndef _WIN32
+    // map the file read-only, so its pages are shared by every process using it
+    input.close();
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0 || (size_t) info.st_size != bytes) {
+        if (fd >= 0) close(fd);
+        error("CompactLexicon: " + fileName + " is damaged");
+    }
+    void* address = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) error("CompactLexicon: cannot map " + fileName);
+    lexicon->mapping = shared_ptr<const void>(address, [bytes](const void* mapped) {
+        munmap((void*) mapped, bytes);
+    });
+    lexicon->nodes = (const Node*) ((const char*) address + sizeof(header));
+#else
+    // no mmap: read the nodes instead
+    lexicon->storage.resize(lexicon->nodeCount);
+    input.read((char*) lexicon->storage.data(), bytes - sizeof(header));
+    if (!input || input.peek() != EOF) error("CompactLexicon: " + fileName + " is damaged");
+    lexicon->nodes = lexicon->storage.data();
+#endif
+
+    lexicon->checkNodes(fileName);
+    return lexicon;
+}
+
+void CompactLexicon::checkNodes(const string& fileName) const {
+    if (nodeCount < 1) error("CompactLexicon: " + fileName + " is damaged");
+    for (int n = 0; n < nodeCount; n++) {
+        int size = popcount(nodes[n].childMask & LETTER_BITS);
+        if (size > 0 && (nodes[n].firstChild == 0 || nodes[n].firstChild + (int64_t) size > nodeCount)) {
+            error("CompactLexicon: " + fileName + " is damaged");
+        }
+    }
+}
+
+void CompactLexicon::save(const string& fileName) const {
+    ofstream output(fileName, ios::binary | ios::trunc);
+    uint32_t header[FILE_HEADER_WORDS] = {FILE_MAGIC, FILE_VERSION, (uint32_t) wordCount, (uint32_t) nodeCount};
+    output.write((const char*) header, sizeof(header));
+    output.write((const char*) nodes, (size_t) nodeCount * sizeof(Node));
+    if (!output) error("CompactLexicon: cannot write " + fileName);
+}
+
+string CompactLexicon::wordAt(int number) const {
+    if (number < 0 || number >= wordCount) error("CompactLexicon: no word has number " + to_string(number));
+
+    // go down to the last child whose words start at or before number, taking off
+    // the words passed over
+    string word;
+    int node = ROOT;
+    while (!isWord(node) || number > 0) {
+        if (isWord(node)) number--;
+
+        int next = -1;
+        char letter = 0;
+        for (int i = 0, c = nodes[node].firstChild; i < 26; i++) {
+            if ((nodes[node].childMask & (1u << i)) == 0) continue;
+            if ((int) nodes[c].wordsBefore > number) break;
+            next = c++;
+            letter = 'a' + i;
+        }
+        number -= nodes[next].wordsBefore;
+        word += letter;
+        node = next;
+    }
+    return word;
+}
+
+int CompactLexicon::find(const string& prefix) const {
+    int node = ROOT;
+    for (int i = 0; i < (int) prefix.length() && node >= 0; i++) {
+        node = child(node, prefix[i]);
+    }
+    return node;
+}
+
+bool CompactLexicon::contains(const string& word) const {
+    int node = find(word);
+    return node >= 0 && isWord(node);
+}
+
+bool CompactLexicon::containsPrefix(const string& prefix) const {
+    return find(prefix) >= 0;
+}
+
+int CompactLexicon::size() const {
+    return wordCount;
+}
+
+int CompactLexicon::numNodes() const {
+    return nodeCount;
+}
@@ -0,0 +1,190 @@
+//
+//  compactlexicon.h
+//
+//  A read-only dictionary of A-Z words stored as a flat array trie, so that a search
+//  can walk it one letter at a time with a node cursor instead of looking up every
+//  prefix again from the root. Equal subtrees are merged (a DAWG), and the nodes can be
+//  saved to a file that is later mapped straight into memory instead of rebuilt.
+//
+//  Used by HW2_Serafini (word ladder) and HW4_Boggle: a project that includes this
+//  header must also compile Shared/compactlexicon.cpp.
+//
+//  Created by Jian Zhong on 7/20/20.
+//  Copyright © 2020 Jian Zhong. All rights reserved.
+//
+
+#ifndef _compactlexicon_h
+#define _compactlexicon_h
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lexicon.h"
+
+using namespace std;
+
+class CompactLexicon {
+public:
+    /* The node of the empty prefix */
+    static const int ROOT = 0;
+
+    /* Heights are stored up to this; a node of this height may have longer words below */
+    static const int MAX_HEIGHT = 31;
+
+    /*
+     * Construct the dictionary of the words of a lexicon; words with letters outside
+     * A-Z (in either case) are left out.
+     */
+    CompactLexicon(const Lexicon& lexicon);
+
+    /*
+     * Construct the dictionary of a list of words in any order and case; words with
+     * letters outside A-Z are left out.
+     */
+    CompactLexicon(const vector<string>& words);
+
+    /*
+     * Open a dictionary file: a file written by save is mapped into memory read-only,
+     * and anything else is read as a word list, one word per line.
+     */
+    static shared_ptr<const CompactLexicon> open(const string& fileName);
+
+    /*
+     * Write the dictionary to a file that open can map.
+     */
+    void save(const string& fileName) const;
+
+    /*
+     * Return the node of prefix + letter, given the node of prefix, or -1 if no word
+     * starts with it. Letters are case-insensitive.
+     */
+    int child(int node, char letter) const {
+        int index = (letter | 0x20) - 'a';  // fold to lower case
+        if (index < 0 || index >= 26) return -1;
+
+        uint32_t bit = 1u << index;
+        const Node& n = nodes[node];
+        if ((n.childMask & bit) == 0) return -1;
+        return n.firstChild + popcount(n.childMask & (bit - 1));
+    }
+
+    /*
+     * Return true if the prefix of node is a word.
+     */
+    bool isWord(int node) const {
+        return (nodes[node].childMask & WORD_BIT) != 0;
+    }
+
+    /*
+     * Return the most letters any word may still add to the prefix of node, or
+     * MAX_HEIGHT if it may be that many or more.
+     */
+    int height(int node) const {
+        return (nodes[node].childMask & HEIGHT_BITS) >> HEIGHT_SHIFT;
+    }
+
+    /*
+     * Return the number of a child's prefix, given its parent node and the number of the
+     * parent's prefix (0 for ROOT). The number of a prefix is how many words sort before
+     * it, so every word has its own number in 0 .. size() - 1 even though many words end
+     * on the same node.
+     */
+    int childNumber(int node, int number, int child) const {
+        return number + isWord(node) + nodes[child].wordsBefore;
+    }
+
+    /*
+     * Return the word with a number, in lower case: the word at that position in
+     * sorted order.
+     */
+    string wordAt(int number) const;
+
+    /*
+     * Return the node of a prefix, or -1 if no word starts with it.
+     */
+    int find(const string& prefix) const;
+
+    /*
+     * Check if a word is in the dictionary, ignoring case.
+     */
+    bool contains(const string& word) const;
+
+    /*
+     * Check if any word in the dictionary starts with prefix, ignoring case.
+     */
+    bool containsPrefix(const string& prefix) const;
+
+    /*
+     * Get the number of words.
+     */
+    int size() const;
+
+    /*
+     * Get the number of nodes; node ids are 0 .. numNodes() - 1.
+     */
+    int numNodes() const;
+
+private:
+    /*
+     * A trie node. The children of a node are stored next to each other in letter
+     * order, starting at firstChild; bit i of childMask says whether letter 'a' + i
+     * has a child, so a child's index is firstChild plus the set bits below its own.
+     * The bits above the letters hold the node's height and whether it is a word.
+     * Nodes whose subtrees are equal share one block of children. wordsBefore counts
+     * the words below the node's earlier siblings, for childNumber.
+     */
+    struct Node {
+        uint32_t childMask;
+        uint32_t firstChild;
+        uint32_t wordsBefore;
+    };
+
+    static const uint32_t WORD_BIT = 1u << 31;          // in childMask: the prefix is a word
+    static const uint32_t LETTER_BITS = (1u << 26) - 1;  // in childMask: the children
+    static const int HEIGHT_SHIFT = 26;                  // in childMask: the height
+    static const uint32_t HEIGHT_BITS = (uint32_t) MAX_HEIGHT << HEIGHT_SHIFT;
+
+    static int popcount(uint32_t bits) {
+#ifdef __GNUC__
+        return __builtin_popcount(bits);
+#else
+        int count = 0;
+        for (; bits != 0; bits &= bits - 1) count++;
+        return count;
+#endif
+    }
+
+    CompactLexicon();
+    CompactLexicon(const CompactLexicon&) = delete;             // nodes may point into storage
+    CompactLexicon& operator=(const CompactLexicon&) = delete;
+
+    /*
+     * Lay out the trie of a word list breadth first: the children of a node go in one
+     * block at the end of the nodes, and all nodes of one depth come before the next
+     * depth, so the short prefixes every search walks through are packed together.
+     */
+    void build(vector<string> words);
+
+    /*
+     * Merge equal blocks of children, turning the trie into a DAWG. Walking the nodes
+     * backwards numbers every block after the blocks below it; a block is known by its
+     * nodes' masks and the numbers of their child blocks, which also fix wordsBefore.
+     * The distinct blocks are then laid out breadth first again.
+     */
+    void minimize();
+
+    /*
+     * Check that the child blocks of a loaded dictionary lie inside its nodes, so a
+     * damaged file is reported instead of read out of bounds.
+     */
+    void checkNodes(const string& fileName) const;
+
+    const Node* nodes;               // nodes[ROOT] is the root; points into storage or mapping
+    int nodeCount;
+    int wordCount;
+    vector<Node> storage;            // the nodes of a dictionary built in memory
+    shared_ptr<const void> mapping;  // the mapped file, unmapped when the dictionary goes
+};
+
+#endif // _compactlexicon_h